@@ -0,0 +1,99 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include "Adafruit_VEML7700.h"
+
+Adafruit_VEML7700::Adafruit_VEML7700()
+{
+    config = 0x0001;
+}
+
+bool Adafruit_VEML7700::begin()
+{
+    // Как в оригинале: GAIN 1/8, IT 100 мс, включение
+    config = (VEML7700_GAIN_1_8 << 11) | (VEML7700_IT_100MS << 6);
+    return writeRegister(VEML7700_ALS_CONFIG, config);
+}
+
+void Adafruit_VEML7700::enable(bool enable)
+{
+    config = enable ? (config & ~0x0001) : (config | 0x0001);
+    writeRegister(VEML7700_ALS_CONFIG, config);
+    if (enable)
+    {
+        delay(5);
+    }
+}
+
+void Adafruit_VEML7700::interruptEnable(bool enable)
+{
+    config = enable ? (config | 0x0002) : (config & ~0x0002);
+    writeRegister(VEML7700_ALS_CONFIG, config);
+}
+
+void Adafruit_VEML7700::setGain(uint8_t gain)
+{
+    config = (config & ~(0x03 << 11)) | ((gain & 0x03) << 11);
+    writeRegister(VEML7700_ALS_CONFIG, config);
+}
+
+void Adafruit_VEML7700::setIntegrationTime(uint8_t it, bool wait)
+{
+    config = (config & ~(0x0F << 6)) | ((it & 0x0F) << 6);
+    writeRegister(VEML7700_ALS_CONFIG, config);
+    if (wait)
+    {
+        delay(100);
+    }
+}
+
+void Adafruit_VEML7700::setLowThreshold(uint16_t value)
+{
+    writeRegister(VEML7700_ALS_THREHOLD_LOW, value);
+}
+
+void Adafruit_VEML7700::setHighThreshold(uint16_t value)
+{
+    writeRegister(VEML7700_ALS_THREHOLD_HIGH, value);
+}
+
+uint16_t Adafruit_VEML7700::readALS(bool wait)
+{
+    (void)wait;
+    uint16_t value = 0;
+    readRegister(VEML7700_ALS_DATA, value);
+    return value;
+}
+
+uint16_t Adafruit_VEML7700::readWhite(bool wait)
+{
+    (void)wait;
+    uint16_t value = 0;
+    readRegister(VEML7700_WHITE_DATA, value);
+    return value;
+}
+
+bool Adafruit_VEML7700::writeRegister(uint8_t reg, uint16_t value)
+{
+    Wire.beginTransmission(VEML7700_I2CADDR_DEFAULT);
+    Wire.write(reg);
+    Wire.write(static_cast<uint8_t>(value & 0xFF));
+    Wire.write(static_cast<uint8_t>(value >> 8));
+    return Wire.endTransmission() == 0;
+}
+
+bool Adafruit_VEML7700::readRegister(uint8_t reg, uint16_t& value)
+{
+    Wire.beginTransmission(VEML7700_I2CADDR_DEFAULT);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0)
+    {
+        return false;
+    }
+    if (Wire.requestFrom(static_cast<uint8_t>(VEML7700_I2CADDR_DEFAULT), static_cast<uint8_t>(2)) != 2)
+    {
+        return false;
+    }
+    value = Wire.read();
+    value |= Wire.read() << 8;
+    return true;
+}
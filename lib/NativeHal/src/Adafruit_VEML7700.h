@@ -0,0 +1,50 @@
+#ifndef NATIVE_ADAFRUIT_VEML7700_H
+#define NATIVE_ADAFRUIT_VEML7700_H
+
+#include <stdint.h>
+
+// Подмножество Adafruit_VEML7700 для сборки под хост, обмен - регистрами по Wire
+
+#define VEML7700_I2CADDR_DEFAULT 0x10
+
+#define VEML7700_ALS_CONFIG 0x00
+#define VEML7700_ALS_THREHOLD_HIGH 0x01
+#define VEML7700_ALS_THREHOLD_LOW 0x02
+#define VEML7700_ALS_DATA 0x04
+#define VEML7700_WHITE_DATA 0x05
+
+#define VEML7700_GAIN_1 0x00
+#define VEML7700_GAIN_2 0x01
+#define VEML7700_GAIN_1_8 0x02
+#define VEML7700_GAIN_1_4 0x03
+
+#define VEML7700_IT_100MS 0x00
+#define VEML7700_IT_200MS 0x01
+#define VEML7700_IT_400MS 0x02
+#define VEML7700_IT_800MS 0x03
+#define VEML7700_IT_50MS 0x08
+#define VEML7700_IT_25MS 0x0C
+
+class Adafruit_VEML7700
+{
+private:
+    uint16_t config;
+
+    bool writeRegister(uint8_t reg, uint16_t value);
+    bool readRegister(uint8_t reg, uint16_t& value);
+
+public:
+    Adafruit_VEML7700();
+
+    bool begin();
+    void enable(bool enable);
+    void interruptEnable(bool enable);
+    void setGain(uint8_t gain);
+    void setIntegrationTime(uint8_t it, bool wait = true);
+    void setLowThreshold(uint16_t value);
+    void setHighThreshold(uint16_t value);
+    uint16_t readALS(bool wait = false);
+    uint16_t readWhite(bool wait = false);
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "Arduino.h"
+#include "Simulator.h"
+
+volatile uint8_t PCICR = 0;
+volatile uint8_t PCIFR = 0;
+volatile uint8_t PCMSK0 = 0;
+volatile uint8_t PCMSK1 = 0;
+volatile uint8_t PCMSK2 = 0;
+volatile uint8_t ADMUX = 0;
+volatile uint8_t ADCSRA = 0;
+volatile uint8_t ADCSRB = 0;
+volatile uint8_t DIDR0 = 0;
+volatile uint16_t ADC = 0;
+
+unsigned long millis()
+{
+    return static_cast<unsigned long>(static_cast<uint32_t>(Simulator::cpuTime() / 1000ULL));
+}
+
+unsigned long micros()
+{
+    return static_cast<unsigned long>(static_cast<uint32_t>(Simulator::cpuTime()));
+}
+
+void delay(unsigned long ms)
+{
+    Simulator::advance(static_cast<uint64_t>(ms) * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    Simulator::advance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    Simulator::setPinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    Simulator::writePin(pin, val);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return Simulator::readPin(pin);
+}
+
+int analogRead(uint8_t pin)
+{
+    // Преобразование АЦП на Uno занимает ~112 мкс
+    Simulator::advance(112);
+    return Simulator::readAnalog(pin);
+}
+
+void analogWrite(uint8_t pin, int val)
+{
+    Simulator::writePwm(pin, static_cast<uint8_t>(constrain(val, 0, 255)));
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+void noInterrupts()
+{
+    Simulator::setInterrupts(false);
+}
+
+void interrupts()
+{
+    Simulator::setInterrupts(true);
+}
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+    return pin < 8 ? 0 : (pin < 14 ? 1 : 2);
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+    return static_cast<uint8_t>(1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14)));
+}
+
+volatile uint8_t* portInputRegister(uint8_t port)
+{
+    return &Simulator::portInput[port < 3 ? port : 0];
+}
+
+volatile uint8_t* digitalPinToPCICR(uint8_t pin)
+{
+    (void)pin;
+    return &PCICR;
+}
+
+uint8_t digitalPinToPCICRbit(uint8_t pin)
+{
+    return pin < 8 ? PCIE2 : (pin < 14 ? PCIE0 : PCIE1);
+}
+
+volatile uint8_t* digitalPinToPCMSK(uint8_t pin)
+{
+    return pin < 8 ? &PCMSK2 : (pin < 14 ? &PCMSK0 : &PCMSK1);
+}
+
+uint8_t digitalPinToPCMSKbit(uint8_t pin)
+{
+    return pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14);
+}
@@ -0,0 +1,91 @@
+#include <Wire.h>
+#include "DS1307RTC.h"
+
+#define DS1307_CTRL_ID 0x68
+
+static const uint8_t tmNbrFields = 7;
+
+bool DS1307RTC::exists = false;
+
+DS1307RTC RTC;
+
+time_t DS1307RTC::get()
+{
+    tmElements_t tm;
+    if (!read(tm))
+        return 0;
+    return makeTime(tm);
+}
+
+bool DS1307RTC::set(time_t t)
+{
+    tmElements_t tm;
+    breakTime(t, tm);
+    return write(tm);
+}
+
+bool DS1307RTC::read(tmElements_t& tm)
+{
+    Wire.beginTransmission(DS1307_CTRL_ID);
+    Wire.write(static_cast<uint8_t>(0x00));
+    if (Wire.endTransmission() != 0)
+    {
+        exists = false;
+        return false;
+    }
+    exists = true;
+
+    if (Wire.requestFrom(static_cast<uint8_t>(DS1307_CTRL_ID), tmNbrFields) < tmNbrFields)
+        return false;
+
+    uint8_t sec = Wire.read();
+    tm.Second = bcd2dec(sec & 0x7f);
+    tm.Minute = bcd2dec(Wire.read());
+    tm.Hour = bcd2dec(Wire.read() & 0x3f);
+    tm.Wday = bcd2dec(Wire.read());
+    tm.Day = bcd2dec(Wire.read());
+    tm.Month = bcd2dec(Wire.read());
+    tm.Year = y2kYearToTm(bcd2dec(Wire.read()));
+    if (sec & 0x80)
+        return false;  // часы остановлены
+    return true;
+}
+
+bool DS1307RTC::write(tmElements_t& tm)
+{
+    Wire.beginTransmission(DS1307_CTRL_ID);
+    Wire.write(static_cast<uint8_t>(0x00));
+    Wire.write(static_cast<uint8_t>(0x80));  // остановить часы на время записи
+    Wire.write(dec2bcd(tm.Minute));
+    Wire.write(dec2bcd(tm.Hour));
+    Wire.write(dec2bcd(tm.Wday));
+    Wire.write(dec2bcd(tm.Day));
+    Wire.write(dec2bcd(tm.Month));
+    Wire.write(dec2bcd(tmYearToY2k(tm.Year)));
+    if (Wire.endTransmission() != 0)
+    {
+        exists = false;
+        return false;
+    }
+    exists = true;
+
+    Wire.beginTransmission(DS1307_CTRL_ID);
+    Wire.write(static_cast<uint8_t>(0x00));
+    Wire.write(dec2bcd(tm.Second));
+    if (Wire.endTransmission() != 0)
+    {
+        exists = false;
+        return false;
+    }
+    return true;
+}
+
+uint8_t DS1307RTC::dec2bcd(uint8_t num)
+{
+    return ((num / 10 * 16) + (num % 10));
+}
+
+uint8_t DS1307RTC::bcd2dec(uint8_t num)
+{
+    return ((num / 16 * 10) + (num % 16));
+}
@@ -0,0 +1,26 @@
+#ifndef NATIVE_DS1307RTC_H
+#define NATIVE_DS1307RTC_H
+
+#include "TimeLib.h"
+
+// DS1307RTC для сборки под хост: тот же обмен по Wire, что и в оригинале
+class DS1307RTC
+{
+private:
+    static bool exists;
+    static uint8_t dec2bcd(uint8_t num);
+    static uint8_t bcd2dec(uint8_t num);
+
+public:
+    DS1307RTC() {}
+
+    static time_t get();
+    static bool set(time_t t);
+    static bool read(tmElements_t& tm);
+    static bool write(tmElements_t& tm);
+    static bool chipPresent() { return exists; }
+};
+
+extern DS1307RTC RTC;
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include "Arduino.h"
+#include "Simulator.h"
+
+HardwareSerial Serial;
+
+HardwareSerial::HardwareSerial()
+{
+    baud = 0;
+    lineBusyUntil = 0;
+    rxHead = 0;
+    rxTail = 0;
+}
+
+void HardwareSerial::begin(unsigned long baudRate)
+{
+    baud = baudRate;
+    lineBusyUntil = Simulator::now();
+}
+
+uint32_t HardwareSerial::byteTimeUs() const
+{
+    // 8N1: 10 бит на байт
+    return baud == 0 ? 0 : static_cast<uint32_t>(10000000UL / baud);
+}
+
+uint8_t HardwareSerial::txPending() const
+{
+    uint64_t now = Simulator::now();
+    uint32_t byteTime = byteTimeUs();
+    if (byteTime == 0 || lineBusyUntil <= now)
+    {
+        return 0;
+    }
+    return static_cast<uint8_t>((lineBusyUntil - now + byteTime - 1) / byteTime);
+}
+
+int HardwareSerial::available()
+{
+    return static_cast<uint8_t>(rxHead - rxTail) % RX_BUFFER_SIZE;
+}
+
+int HardwareSerial::peek()
+{
+    if (rxHead == rxTail)
+    {
+        return -1;
+    }
+    return rxBuffer[rxTail];
+}
+
+int HardwareSerial::read()
+{
+    if (rxHead == rxTail)
+    {
+        return -1;
+    }
+    uint8_t c = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) % RX_BUFFER_SIZE;
+    return c;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    return TX_BUFFER_SIZE - 1 - txPending();
+}
+
+void HardwareSerial::flush()
+{
+    uint64_t now = Simulator::now();
+    if (lineBusyUntil > now)
+    {
+        Simulator::advance(lineBusyUntil - now);
+    }
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    uint32_t byteTime = byteTimeUs();
+    if (byteTime == 0)
+    {
+        return 0;
+    }
+
+    // Буфер полон - ждем, пока линия освободит место, как и на плате
+    if (txPending() >= TX_BUFFER_SIZE - 1)
+    {
+        uint64_t freeAt = lineBusyUntil - static_cast<uint64_t>(TX_BUFFER_SIZE - 2) * byteTime;
+        if (freeAt > Simulator::now())
+        {
+            Simulator::advance(freeAt - Simulator::now());
+        }
+    }
+
+    uint64_t now = Simulator::now();
+    lineBusyUntil = (lineBusyUntil > now ? lineBusyUntil : now) + byteTime;
+
+    if (!Simulator::quiet())
+    {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+void HardwareSerial::inject(uint8_t c)
+{
+    uint8_t next = (rxHead + 1) % RX_BUFFER_SIZE;
+    if (next != rxTail)
+    {
+        rxBuffer[rxHead] = c;
+        rxHead = next;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include "Print.h"
+
+// UART с моделью 64-байтного буфера передачи: байты уходят со скоростью
+// линии в виртуальном времени, при полном буфере write() ждет, как на плате
+class HardwareSerial : public Print
+{
+public:
+    static const uint8_t TX_BUFFER_SIZE = 64;
+    static const uint8_t RX_BUFFER_SIZE = 64;
+
+private:
+    unsigned long baud;
+    uint64_t lineBusyUntil;  // мкс виртуального времени, когда опустеет буфер
+    uint8_t rxBuffer[RX_BUFFER_SIZE];
+    uint8_t rxHead;
+    uint8_t rxTail;
+
+    uint32_t byteTimeUs() const;
+    uint8_t txPending() const;
+
+public:
+    HardwareSerial();
+
+    void begin(unsigned long baud);
+    void end() {}
+
+    int available();
+    int peek();
+    int read();
+    int availableForWrite() override;
+    void flush();
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    operator bool() const { return true; }
+
+    // Для симулятора: положить байт в приемный буфер
+    void inject(uint8_t c);
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,129 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include "LiquidCrystal_I2C.h"
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t lcd_addr, uint8_t lcd_cols, uint8_t lcd_rows)
+    : addr(lcd_addr), cols(lcd_cols), rows(lcd_rows)
+{
+    displayControl = 0;
+    backlightVal = LCD_BACKLIGHT;
+}
+
+void LiquidCrystal_I2C::begin()
+{
+    Wire.begin();
+    delay(50);
+
+    expanderWrite(backlightVal);
+    delay(1000);
+
+    // Перевод в 4-битный режим по даташиту
+    write4bits(0x03 << 4);
+    delayMicroseconds(4500);
+    write4bits(0x03 << 4);
+    delayMicroseconds(4500);
+    write4bits(0x03 << 4);
+    delayMicroseconds(150);
+    write4bits(0x02 << 4);
+
+    command(0x20 | 0x08);  // 4 бита, 2 строки, 5x8
+    displayControl = 0x04;
+    display();
+    clear();
+    command(0x04 | 0x02);  // слева направо
+    home();
+}
+
+void LiquidCrystal_I2C::clear()
+{
+    command(0x01);
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::home()
+{
+    command(0x02);
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::noDisplay()
+{
+    displayControl &= ~0x04;
+    command(0x08 | displayControl);
+}
+
+void LiquidCrystal_I2C::display()
+{
+    displayControl |= 0x04;
+    command(0x08 | displayControl);
+}
+
+void LiquidCrystal_I2C::noBacklight()
+{
+    backlightVal = LCD_NOBACKLIGHT;
+    expanderWrite(0);
+}
+
+void LiquidCrystal_I2C::backlight()
+{
+    backlightVal = LCD_BACKLIGHT;
+    expanderWrite(0);
+}
+
+void LiquidCrystal_I2C::createChar(uint8_t location, uint8_t charmap[])
+{
+    location &= 0x7;
+    command(0x40 | (location << 3));
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        write(charmap[i]);
+    }
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row)
+{
+    static const uint8_t rowOffsets[] = {0x00, 0x40, 0x14, 0x54};
+    if (row >= rows)
+    {
+        row = rows - 1;
+    }
+    command(0x80 | (col + rowOffsets[row]));
+}
+
+void LiquidCrystal_I2C::command(uint8_t value)
+{
+    send(value, 0);
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t value)
+{
+    send(value, Rs);
+    return 1;
+}
+
+void LiquidCrystal_I2C::send(uint8_t value, uint8_t mode)
+{
+    write4bits((value & 0xF0) | mode);
+    write4bits(((value << 4) & 0xF0) | mode);
+}
+
+void LiquidCrystal_I2C::write4bits(uint8_t value)
+{
+    expanderWrite(value);
+    pulseEnable(value);
+}
+
+void LiquidCrystal_I2C::expanderWrite(uint8_t data)
+{
+    Wire.beginTransmission(addr);
+    Wire.write(static_cast<uint8_t>(data | backlightVal));
+    Wire.endTransmission();
+}
+
+void LiquidCrystal_I2C::pulseEnable(uint8_t data)
+{
+    expanderWrite(data | En);
+    delayMicroseconds(1);
+    expanderWrite(data & ~En);
+    delayMicroseconds(50);
+}
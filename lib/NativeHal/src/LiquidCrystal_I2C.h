@@ -0,0 +1,48 @@
+#ifndef NATIVE_LIQUID_CRYSTAL_I2C_H
+#define NATIVE_LIQUID_CRYSTAL_I2C_H
+
+#include <stdint.h>
+#include "Print.h"
+
+// LiquidCrystal_I2C для сборки под хост. Протокол тот же, что у библиотеки:
+// HD44780 в 4-битном режиме через PCF8574, каждая тетрада - три записи
+// на расширитель. Экран восстанавливает модель SimLcd.
+class LiquidCrystal_I2C : public Print
+{
+private:
+    static const uint8_t En = 0x04;
+    static const uint8_t Rs = 0x01;
+    static const uint8_t LCD_BACKLIGHT = 0x08;
+    static const uint8_t LCD_NOBACKLIGHT = 0x00;
+
+    uint8_t addr;
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t displayControl;
+    uint8_t backlightVal;
+
+    void send(uint8_t value, uint8_t mode);
+    void write4bits(uint8_t value);
+    void expanderWrite(uint8_t data);
+    void pulseEnable(uint8_t data);
+
+public:
+    LiquidCrystal_I2C(uint8_t lcd_addr, uint8_t lcd_cols, uint8_t lcd_rows);
+
+    void begin();
+    void clear();
+    void home();
+    void noDisplay();
+    void display();
+    void noBacklight();
+    void backlight();
+    bool getBacklight() { return backlightVal == LCD_BACKLIGHT; }
+    void createChar(uint8_t location, uint8_t charmap[]);
+    void setCursor(uint8_t col, uint8_t row);
+    void command(uint8_t value);
+
+    size_t write(uint8_t value) override;
+    using Print::write;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <string.h>
+#include "Print.h"
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+    {
+        if (write(*buffer++))
+            n++;
+        else
+            break;
+    }
+    return n;
+}
+
+size_t Print::write(const char* str)
+{
+    if (str == nullptr)
+        return 0;
+    return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+
+    if (base < 2)
+        base = 10;
+
+    do
+    {
+        char c = n % base;
+        n /= base;
+        *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while (n);
+
+    return write(str);
+}
+
+size_t Print::print(const __FlashStringHelper* str) { return write(reinterpret_cast<const char*>(str)); }
+size_t Print::print(const char str[]) { return write(str); }
+size_t Print::print(char c) { return write(static_cast<uint8_t>(c)); }
+size_t Print::print(unsigned char n, int base) { return print(static_cast<unsigned long>(n), base); }
+size_t Print::print(int n, int base) { return print(static_cast<long>(n), base); }
+size_t Print::print(unsigned int n, int base) { return print(static_cast<unsigned long>(n), base); }
+
+size_t Print::print(long n, int base)
+{
+    if (base == 10 && n < 0)
+    {
+        size_t t = print('-');
+        return t + printNumber(-static_cast<unsigned long>(n), 10);
+    }
+    return printNumber(static_cast<unsigned long>(n), base);
+}
+
+size_t Print::print(unsigned long n, int base) { return printNumber(n, base); }
+
+size_t Print::print(double n, int digits)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return write(buf);
+}
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper* str) { return print(str) + println(); }
+size_t Print::println(const char str[]) { return print(str) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char n, int base) { return print(n, base) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
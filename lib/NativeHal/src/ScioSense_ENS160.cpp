@@ -0,0 +1,47 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include "ScioSense_ENS160.h"
+
+ScioSense_ENS160::ScioSense_ENS160(uint8_t slaveaddr) : address(slaveaddr)
+{
+    isAvailable = false;
+}
+
+bool ScioSense_ENS160::begin(bool debug)
+{
+    (void)debug;
+    isAvailable = false;
+
+    Wire.beginTransmission(address);
+    Wire.write(static_cast<uint8_t>(ENS160_REG_PART_ID));
+    if (Wire.endTransmission(false) != 0)
+    {
+        return false;
+    }
+    if (Wire.requestFrom(address, static_cast<uint8_t>(2)) != 2)
+    {
+        return false;
+    }
+    uint16_t partId = Wire.read();
+    partId |= Wire.read() << 8;
+
+    isAvailable = partId == ENS160_PARTID;
+    if (isAvailable)
+    {
+        setMode(ENS160_OPMODE_IDLE);
+    }
+    return isAvailable;
+}
+
+bool ScioSense_ENS160::setMode(uint8_t mode)
+{
+    Wire.beginTransmission(address);
+    Wire.write(static_cast<uint8_t>(ENS160_REG_OPMODE));
+    Wire.write(mode);
+    if (Wire.endTransmission() != 0)
+    {
+        return false;
+    }
+    delay(10);
+    return true;
+}
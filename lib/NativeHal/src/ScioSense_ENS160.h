@@ -0,0 +1,35 @@
+#ifndef NATIVE_SCIOSENSE_ENS160_H
+#define NATIVE_SCIOSENSE_ENS160_H
+
+#include <stdint.h>
+
+// Подмножество ScioSense_ENS160 для сборки под хост: проверка ID и режим работы
+
+#define ENS160_I2CADDR_0 0x52
+#define ENS160_I2CADDR_1 0x53
+
+#define ENS160_PARTID 0x0160
+
+#define ENS160_REG_PART_ID 0x00
+#define ENS160_REG_OPMODE 0x10
+
+#define ENS160_OPMODE_DEP_SLEEP 0x00
+#define ENS160_OPMODE_IDLE 0x01
+#define ENS160_OPMODE_STD 0x02
+#define ENS160_OPMODE_RESET 0xF0
+
+class ScioSense_ENS160
+{
+private:
+    uint8_t address;
+    bool isAvailable;
+
+public:
+    explicit ScioSense_ENS160(uint8_t slaveaddr);
+
+    bool begin(bool debug = false);
+    bool available() const { return isAvailable; }
+    bool setMode(uint8_t mode);
+};
+
+#endif
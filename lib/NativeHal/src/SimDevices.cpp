@@ -0,0 +1,407 @@
+#include <string.h>
+#include "SimDevices.h"
+#include "TimeLib.h"
+
+static SimAht20 aht20;
+static SimEns160 ens160;
+static SimVeml7700 veml7700;
+static SimDs1307 ds1307;
+static SimLcd lcd(0x27, 16, 2);
+
+void registerSimDevices()
+{
+    Simulator::addDevice(&aht20);
+    Simulator::addDevice(&ens160);
+    Simulator::addDevice(&veml7700);
+    Simulator::addDevice(&ds1307);
+    Simulator::addDevice(&lcd);
+}
+
+const SimLcd& simLcd()
+{
+    return lcd;
+}
+
+static uint8_t toBcd(uint8_t value)
+{
+    return static_cast<uint8_t>(((value / 10) << 4) | (value % 10));
+}
+
+static uint8_t fromBcd(uint8_t value)
+{
+    return static_cast<uint8_t>((value >> 4) * 10 + (value & 0x0F));
+}
+
+// ---------------------------------------------------------------- AHT20
+
+SimAht20::SimAht20() : SimI2CDevice(0x38, "aht20")
+{
+    calibrated = false;
+    readyAt = 0;
+    memset(frame, 0, sizeof(frame));
+}
+
+void SimAht20::onWrite(const uint8_t* data, uint8_t len)
+{
+    if (len == 0)
+        return;
+
+    if (data[0] == 0xBE)
+    {
+        calibrated = true;
+    }
+    else if (data[0] == 0xAC)
+    {
+        const SimEnvironment& env = Simulator::environment();
+        double hum = env.humidity < 0 ? 0 : (env.humidity > 100 ? 100 : env.humidity);
+        uint32_t rawHum = static_cast<uint32_t>(hum / 100.0 * 1048575.0);
+        uint32_t rawTemp = static_cast<uint32_t>((env.temperature + 50.0) / 200.0 * 1048575.0);
+
+        frame[1] = rawHum >> 12;
+        frame[2] = rawHum >> 4;
+        frame[3] = ((rawHum & 0x0F) << 4) | ((rawTemp >> 16) & 0x0F);
+        frame[4] = rawTemp >> 8;
+        frame[5] = rawTemp;
+        readyAt = Simulator::now() + CONVERSION_US;
+    }
+}
+
+uint8_t SimAht20::onRead(uint8_t* data, uint8_t len)
+{
+    uint8_t status = 0x10 | (calibrated ? 0x08 : 0x00);
+    if (Simulator::now() < readyAt)
+    {
+        status |= 0x80;
+    }
+    frame[0] = status;
+
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        crc ^= frame[i];
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    frame[6] = crc;
+
+    uint8_t n = len < sizeof(frame) ? len : sizeof(frame);
+    memcpy(data, frame, n);
+    return n;
+}
+
+// ---------------------------------------------------------------- ENS160
+
+SimEns160::SimEns160() : SimI2CDevice(0x53, "ens160")
+{
+    memset(regs, 0, sizeof(regs));
+    regs[0x00] = 0x60;  // PART_ID = 0x0160
+    regs[0x01] = 0x01;
+    pointer = 0;
+    nextSampleAt = 0;
+}
+
+void SimEns160::refresh()
+{
+    if (regs[0x10] != 0x02 || Simulator::now() < nextSampleAt)
+        return;
+
+    const SimEnvironment& env = Simulator::environment();
+    uint16_t eco2 = static_cast<uint16_t>(env.eco2 < 400 ? 400 : env.eco2);
+    uint16_t tvoc = static_cast<uint16_t>(env.tvoc < 0 ? 0 : env.tvoc);
+    uint8_t aqi = eco2 < 600 ? 1 : eco2 < 800 ? 2 : eco2 < 1000 ? 3 : eco2 < 1500 ? 4 : 5;
+
+    regs[0x21] = aqi;
+    regs[0x22] = tvoc & 0xFF;
+    regs[0x23] = tvoc >> 8;
+    regs[0x24] = eco2 & 0xFF;
+    regs[0x25] = eco2 >> 8;
+    regs[0x20] = 0x80 | 0x02;  // STATAS | NEWDAT, validity = норма
+    nextSampleAt += SAMPLE_PERIOD_US;
+    if (nextSampleAt <= Simulator::now())
+    {
+        nextSampleAt = Simulator::now() + SAMPLE_PERIOD_US;
+    }
+}
+
+void SimEns160::onWrite(const uint8_t* data, uint8_t len)
+{
+    if (len == 0)
+        return;
+
+    pointer = data[0] & 0x3F;
+    for (uint8_t i = 1; i < len; i++)
+    {
+        if (pointer == 0x10)
+        {
+            nextSampleAt = Simulator::now() + SAMPLE_PERIOD_US;
+        }
+        regs[pointer] = data[i];
+        pointer = (pointer + 1) & 0x3F;
+    }
+    refresh();
+}
+
+uint8_t SimEns160::onRead(uint8_t* data, uint8_t len)
+{
+    refresh();
+    for (uint8_t i = 0; i < len; i++)
+    {
+        data[i] = regs[pointer];
+        if (pointer >= 0x21 && pointer <= 0x25)
+        {
+            regs[0x20] &= ~0x02;  // чтение данных снимает NEWDAT
+        }
+        pointer = (pointer + 1) & 0x3F;
+    }
+    return len;
+}
+
+// ---------------------------------------------------------------- VEML7700
+
+SimVeml7700::SimVeml7700() : SimI2CDevice(0x10, "veml7700")
+{
+    memset(regs, 0, sizeof(regs));
+    regs[0] = 0x0001;  // после подачи питания - shutdown
+    pointer = 0;
+}
+
+uint16_t SimVeml7700::alsCounts() const
+{
+    uint16_t conf = regs[0];
+    if (conf & 0x0001)
+        return 0;
+
+    static const double gains[4] = {1.0, 2.0, 0.125, 0.25};
+    double gain = gains[(conf >> 11) & 0x03];
+
+    double itMs;
+    switch ((conf >> 6) & 0x0F)
+    {
+    case 0x0C: itMs = 25; break;
+    case 0x08: itMs = 50; break;
+    case 0x01: itMs = 200; break;
+    case 0x02: itMs = 400; break;
+    case 0x03: itMs = 800; break;
+    default: itMs = 100; break;
+    }
+
+    double resolution = 0.0036 * (2.0 / gain) * (800.0 / itMs);
+    double counts = Simulator::environment().lux / resolution;
+    return counts > 65535.0 ? 65535 : static_cast<uint16_t>(counts);
+}
+
+void SimVeml7700::onWrite(const uint8_t* data, uint8_t len)
+{
+    if (len == 0)
+        return;
+
+    pointer = data[0] & 0x07;
+    if (len >= 3)
+    {
+        regs[pointer] = data[1] | (data[2] << 8);
+    }
+}
+
+uint8_t SimVeml7700::onRead(uint8_t* data, uint8_t len)
+{
+    uint16_t value = pointer == 4 ? alsCounts() : pointer == 5 ? alsCounts() : regs[pointer];
+    uint8_t bytes[2] = {static_cast<uint8_t>(value & 0xFF), static_cast<uint8_t>(value >> 8)};
+    uint8_t n = len < 2 ? len : 2;
+    memcpy(data, bytes, n);
+    return n;
+}
+
+// ---------------------------------------------------------------- DS1307
+
+SimDs1307::SimDs1307() : SimI2CDevice(0x68, "ds1307", 100000)
+{
+    memset(regs, 0, sizeof(regs));
+    pointer = 0;
+    offsetSeconds = 0;
+}
+
+uint32_t SimDs1307::currentEpoch() const
+{
+    return static_cast<uint32_t>(Simulator::startEpoch() + Simulator::elapsed() / 1000000ULL + offsetSeconds);
+}
+
+void SimDs1307::latchTime()
+{
+    tmElements_t tm;
+    breakTime(currentEpoch(), tm);
+    regs[0] = toBcd(tm.Second);
+    regs[1] = toBcd(tm.Minute);
+    regs[2] = toBcd(tm.Hour);
+    regs[3] = tm.Wday;
+    regs[4] = toBcd(tm.Day);
+    regs[5] = toBcd(tm.Month);
+    regs[6] = toBcd(tmYearToY2k(tm.Year));
+}
+
+void SimDs1307::onWrite(const uint8_t* data, uint8_t len)
+{
+    if (len == 0)
+        return;
+
+    pointer = data[0] & 0x3F;
+    bool timeWritten = false;
+    if (len > 1 && pointer < 7)
+    {
+        latchTime();
+    }
+    for (uint8_t i = 1; i < len; i++)
+    {
+        if (pointer < 7)
+        {
+            timeWritten = true;
+        }
+        regs[pointer] = data[i];
+        pointer = (pointer + 1) & 0x3F;
+    }
+
+    if (timeWritten)
+    {
+        tmElements_t tm;
+        tm.Second = fromBcd(regs[0] & 0x7F);
+        tm.Minute = fromBcd(regs[1]);
+        tm.Hour = fromBcd(regs[2] & 0x3F);
+        tm.Wday = regs[3];
+        tm.Day = fromBcd(regs[4]);
+        tm.Month = fromBcd(regs[5]);
+        tm.Year = y2kYearToTm(fromBcd(regs[6]));
+        int64_t written = static_cast<int64_t>(makeTime(tm));
+        int64_t base = static_cast<int64_t>(Simulator::startEpoch() + Simulator::elapsed() / 1000000ULL);
+        offsetSeconds = written - base;
+    }
+}
+
+uint8_t SimDs1307::onRead(uint8_t* data, uint8_t len)
+{
+    if (pointer < 7)
+    {
+        latchTime();
+    }
+    for (uint8_t i = 0; i < len; i++)
+    {
+        data[i] = regs[pointer];
+        pointer = (pointer + 1) & 0x3F;
+    }
+    return len;
+}
+
+// ---------------------------------------------------------------- LCD
+
+SimLcd::SimLcd(uint8_t address, uint8_t cols, uint8_t rows)
+    : SimI2CDevice(address, "lcd", 100000), cols(cols), rows(rows)
+{
+    memset(ddram, ' ', sizeof(ddram));
+    cursor = 0;
+    cgramMode = false;
+    fourBitMode = false;
+    haveHighNibble = false;
+    highNibble = 0;
+    lastPort = 0;
+    commands = 0;
+    characters = 0;
+    backlight = false;
+}
+
+void SimLcd::onWrite(const uint8_t* data, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t port = data[i];
+        // Данные защелкиваются по спаду EN
+        if ((lastPort & EN) && !(port & EN))
+        {
+            latchNibble(lastPort);
+        }
+        backlight = (port & BACKLIGHT) != 0;
+        lastPort = port;
+    }
+}
+
+uint8_t SimLcd::onRead(uint8_t* data, uint8_t len)
+{
+    memset(data, lastPort, len);
+    return len;
+}
+
+void SimLcd::latchNibble(uint8_t port)
+{
+    uint8_t nibble = port >> 4;
+
+    if (!fourBitMode)
+    {
+        // 8-битный режим после включения: каждая тетрада - отдельная команда
+        if (nibble == 0x02)
+        {
+            fourBitMode = true;
+            haveHighNibble = false;
+        }
+        return;
+    }
+
+    if (!haveHighNibble)
+    {
+        highNibble = nibble;
+        haveHighNibble = true;
+        return;
+    }
+
+    haveHighNibble = false;
+    execute(static_cast<uint8_t>((highNibble << 4) | nibble), (port & RS) != 0);
+}
+
+void SimLcd::execute(uint8_t value, bool data)
+{
+    if (data)
+    {
+        if (!cgramMode)
+        {
+            ddram[cursor & 0x7F] = value;
+            cursor = (cursor + 1) & 0x7F;
+            characters++;
+        }
+        return;
+    }
+
+    commands++;
+    if (value == 0x01)
+    {
+        memset(ddram, ' ', sizeof(ddram));
+        cursor = 0;
+        cgramMode = false;
+    }
+    else if ((value & 0xFE) == 0x02)
+    {
+        cursor = 0;
+        cgramMode = false;
+    }
+    else if (value & 0x80)
+    {
+        cursor = value & 0x7F;
+        cgramMode = false;
+    }
+    else if (value & 0x40)
+    {
+        cgramMode = true;
+    }
+}
+
+void SimLcd::dump(FILE* out) const
+{
+    static const uint8_t rowOffsets[4] = {0x00, 0x40, 0x14, 0x54};
+    for (uint8_t row = 0; row < rows && row < 4; row++)
+    {
+        fputc('|', out);
+        for (uint8_t col = 0; col < cols; col++)
+        {
+            uint8_t c = ddram[(rowOffsets[row] + col) & 0x7F];
+            fputc(c < 0x20 ? '#' : (c > 0x7E ? '?' : c), out);
+        }
+        fputs("|\n", out);
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef NATIVE_SIM_DEVICES_H
+#define NATIVE_SIM_DEVICES_H
+
+#include <stdio.h>
+#include "Simulator.h"
+
+// Модели I2C-устройств теплицы на уровне регистров.
+// Значения берут из Simulator::environment().
+
+class SimAht20 : public SimI2CDevice
+{
+private:
+    bool calibrated;
+    uint64_t readyAt;
+    uint8_t frame[7];
+
+public:
+    static const uint32_t CONVERSION_US = 75000;
+
+    SimAht20();
+    void onWrite(const uint8_t* data, uint8_t len) override;
+    uint8_t onRead(uint8_t* data, uint8_t len) override;
+};
+
+class SimEns160 : public SimI2CDevice
+{
+private:
+    uint8_t regs[0x40];
+    uint8_t pointer;
+    uint64_t nextSampleAt;
+
+    void refresh();
+
+public:
+    static const uint32_t SAMPLE_PERIOD_US = 1000000;
+
+    SimEns160();
+    void onWrite(const uint8_t* data, uint8_t len) override;
+    uint8_t onRead(uint8_t* data, uint8_t len) override;
+};
+
+class SimVeml7700 : public SimI2CDevice
+{
+private:
+    uint16_t regs[8];
+    uint8_t pointer;
+
+    uint16_t alsCounts() const;
+
+public:
+    SimVeml7700();
+    void onWrite(const uint8_t* data, uint8_t len) override;
+    uint8_t onRead(uint8_t* data, uint8_t len) override;
+};
+
+class SimDs1307 : public SimI2CDevice
+{
+private:
+    uint8_t regs[64];      // 0..7 - часы, 8..63 - NVRAM
+    uint8_t pointer;
+    int64_t offsetSeconds; // поправка после записи времени
+
+    uint32_t currentEpoch() const;
+    void latchTime();
+
+public:
+    SimDs1307();
+    void onWrite(const uint8_t* data, uint8_t len) override;
+    uint8_t onRead(uint8_t* data, uint8_t len) override;
+};
+
+// PCF8574 + HD44780 в 4-битном режиме: восстанавливает содержимое экрана
+// из потока байтов на расширитель, как это делает настоящий контроллер
+class SimLcd : public SimI2CDevice
+{
+private:
+    static const uint8_t EN = 0x04;
+    static const uint8_t RS = 0x01;
+    static const uint8_t BACKLIGHT = 0x08;
+
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t ddram[0x80];
+    uint8_t cursor;
+    bool cgramMode;
+    bool fourBitMode;
+    bool haveHighNibble;
+    uint8_t highNibble;
+    uint8_t lastPort;
+
+    void latchNibble(uint8_t port);
+    void execute(uint8_t value, bool data);
+
+public:
+    uint32_t commands;
+    uint32_t characters;
+    bool backlight;
+
+    SimLcd(uint8_t address, uint8_t cols, uint8_t rows);
+    void onWrite(const uint8_t* data, uint8_t len) override;
+    uint8_t onRead(uint8_t* data, uint8_t len) override;
+
+    void dump(FILE* out) const;
+};
+
+void registerSimDevices();
+const SimLcd& simLcd();
+
+// EEPROM: образ в файле между запусками (path == nullptr - только в памяти)
+bool loadSimEeprom(const char* path);
+void saveSimEeprom();
+void reportSimEeprom(FILE* out);
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "avr/eeprom.h"
+#include "SimDevices.h"
+#include "Simulator.h"
+
+static const uint16_t EEPROM_SIZE = E2END + 1;
+static const uint32_t EEPROM_WRITE_US = 3400;
+
+static uint8_t cells[EEPROM_SIZE];
+static uint32_t cellWrites[EEPROM_SIZE];
+static uint64_t busyUntil = 0;
+static const char* imagePath = nullptr;
+
+static uint16_t cellIndex(const void* addr)
+{
+    return static_cast<uint16_t>(reinterpret_cast<uintptr_t>(addr) & E2END);
+}
+
+bool loadSimEeprom(const char* path)
+{
+    memset(cells, 0xFF, sizeof(cells));  // стертая EEPROM
+    imagePath = path;
+    if (path == nullptr)
+        return true;
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+        return true;  // первый запуск: файл появится при сохранении
+
+    size_t n = fread(cells, 1, sizeof(cells), file);
+    fclose(file);
+    if (n != sizeof(cells))
+    {
+        fprintf(stderr, "eeprom image %s: expected %u bytes\n", path, EEPROM_SIZE);
+        return false;
+    }
+    return true;
+}
+
+void saveSimEeprom()
+{
+    if (imagePath == nullptr)
+        return;
+
+    FILE* file = fopen(imagePath, "wb");
+    if (file == nullptr || fwrite(cells, 1, sizeof(cells), file) != sizeof(cells))
+    {
+        fprintf(stderr, "cannot write eeprom image %s\n", imagePath);
+    }
+    if (file != nullptr)
+        fclose(file);
+}
+
+void reportSimEeprom(FILE* out)
+{
+    uint32_t total = 0;
+    uint32_t worst = 0;
+    for (uint16_t i = 0; i < EEPROM_SIZE; i++)
+    {
+        total += cellWrites[i];
+        if (cellWrites[i] > worst)
+            worst = cellWrites[i];
+    }
+    fprintf(out, "eeprom: %lu byte writes, most-written cell %lu\n", static_cast<unsigned long>(total),
+            static_cast<unsigned long>(worst));
+}
+
+bool eeprom_is_ready()
+{
+    return Simulator::now() >= busyUntil;
+}
+
+uint8_t eeprom_read_byte(const uint8_t* addr)
+{
+    if (!eeprom_is_ready())
+        Simulator::advance(busyUntil - Simulator::now());
+    return cells[cellIndex(addr)];
+}
+
+void eeprom_write_byte(uint8_t* addr, uint8_t value)
+{
+    if (!eeprom_is_ready())
+        Simulator::advance(busyUntil - Simulator::now());
+
+    uint16_t i = cellIndex(addr);
+    cells[i] = value;
+    cellWrites[i]++;
+    busyUntil = Simulator::now() + EEPROM_WRITE_US;
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value)
+{
+    if (eeprom_read_byte(addr) != value)
+        eeprom_write_byte(addr, value);
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    const uint8_t* addr = static_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < n; i++)
+        out[i] = eeprom_read_byte(addr + i);
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n)
+{
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    uint8_t* addr = static_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < n; i++)
+        eeprom_update_byte(addr + i, in[i]);
+}
@@ -0,0 +1,863 @@
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Arduino.h"
+#include "Simulator.h"
+#include "SimDevices.h"
+#include "TimeLib.h"
+
+extern "C" void PCINT0_vect(void) __attribute__((weak));
+extern "C" void PCINT1_vect(void) __attribute__((weak));
+extern "C" void PCINT2_vect(void) __attribute__((weak));
+extern "C" void ADC_vect(void) __attribute__((weak));
+
+// Каналы сценария
+enum Channel
+{
+    CH_TEMP,
+    CH_HUM,
+    CH_ECO2,
+    CH_TVOC,
+    CH_LUX,
+    CH_SOIL_1,
+    CH_SOIL_2,
+    CH_WATER,
+    CH_ONLINE, // CH_ONLINE + индекс устройства
+    CH_STUCK = CH_ONLINE + Simulator::MAX_DEVICES  // CH_STUCK + индекс устройства
+};
+
+static const char* const channelNames[] = {"temp", "hum", "eco2", "tvoc", "lux", "soil1", "soil2", "water"};
+
+// Модель бака и насоса
+static const double TANK_HEIGHT_MM = 300.0;
+static const double TANK_AREA_MM2 = 785398.0;
+// Напор, а с ним и подача насоса, падает вместе с уровнем в баке
+static const double PUMP_ML_PER_MIN_EMPTY = 70.0;
+static const double PUMP_ML_PER_MIN_FULL = 110.0;
+static const double SOIL_PERCENT_PER_ML = 0.05;
+static const double SOIL_DRY_PERCENT_PER_S = 1.5 / 3600.0;
+static const uint64_t PHYSICS_STEP_US = 10000;
+// Воздух теплицы меняется не мгновенно: эффект вентилятора нарастает с этой постоянной
+static const double AIR_EXCHANGE_TAU_S = 180.0;
+// Досветка на полной мощности, у датчика
+static const double LAMP_LUX = 8000.0;
+// Почва впитывает не сразу: вода стоит на поверхности, лишнее сверх лужи стекает
+static const double SOIL_SOAK_TAU_S = 240.0;
+static const double SOIL_POOL_MAX_ML = 60.0;
+
+// Timer0 на Uno переполняется каждые 1024 мкс, преобразование при делителе 128 - 104 мкс
+static const uint64_t TIMER0_OVERFLOW_US = 1024;
+static const uint64_t ADC_CONVERSION_US = 104;
+
+SimI2CDevice::SimI2CDevice(uint8_t address, const char* name, uint32_t maxClockHz)
+    : address(address), name(name), maxClockHz(maxClockHz)
+{
+    online = true;
+    stuckClocks = 0;
+    transactions = 0;
+    bytes = 0;
+    nacks = 0;
+    overclocked = 0;
+    timeouts = 0;
+}
+
+volatile uint8_t Simulator::portInput[3];
+
+uint64_t Simulator::nowUs = 0;
+uint64_t Simulator::startUs = 0;
+uint64_t Simulator::endUs = 86400ULL * 1000000ULL;
+uint64_t Simulator::loopCostUs = 20;
+uint64_t Simulator::lcdEveryUs = 0;
+uint64_t Simulator::lastLcdDumpUs = 0;
+uint64_t Simulator::lastPhysicsUs = 0;
+uint64_t Simulator::trigHighAt = 0;
+uint32_t Simulator::busClockHz = 100000;
+uint32_t Simulator::epoch = 0;
+int32_t Simulator::clockPpm = 0;
+double Simulator::evaporationMmPerDay = 0.0;
+bool Simulator::quietSerial = false;
+bool Simulator::interruptsEnabled = true;
+uint8_t Simulator::pcintPending = 0;
+bool Simulator::adcPending = false;
+uint64_t Simulator::adcNextUs = 0;
+
+uint8_t Simulator::pinModes[NUM_PINS];
+uint8_t Simulator::pinLevels[NUM_PINS];
+uint8_t Simulator::pinPwm[NUM_PINS];
+
+double Simulator::airExchange = 0.0;
+double Simulator::soilPoolMl = 0.0;
+double Simulator::runoffMl = 0.0;
+double Simulator::lampEnergyS = 0.0;
+double Simulator::plantLightLuxS = 0.0;
+
+Simulator::PinEvent Simulator::events[MAX_EVENTS];
+uint8_t Simulator::eventCount = 0;
+
+SimI2CDevice* Simulator::devices[MAX_DEVICES];
+uint8_t Simulator::deviceCount = 0;
+
+SimEnvironment Simulator::env;
+
+Simulator::Keyframe Simulator::keyframes[MAX_KEYFRAMES];
+uint8_t Simulator::keyframeChannel[MAX_KEYFRAMES];
+uint16_t Simulator::keyframeCount = 0;
+uint16_t Simulator::keyframeApplied = 0;
+
+uint64_t Simulator::inputTimes[MAX_INPUTS];
+const char* Simulator::inputTexts[MAX_INPUTS];
+uint8_t Simulator::inputCount = 0;
+uint8_t Simulator::inputDelivered = 0;
+uint8_t Simulator::rawInput[MAX_RAW_INPUT];
+uint16_t Simulator::rawInputSize = 0;
+uint16_t Simulator::rawInputDelivered = 0;
+uint64_t Simulator::rawInputStartUs = 0;
+
+uint64_t Simulator::loopPasses = 0;
+uint64_t Simulator::loopMaxUs = 0;
+uint64_t Simulator::loopTotalUs = 0;
+uint64_t Simulator::actuatorOnUs[3];
+uint32_t Simulator::actuatorToggles[3];
+uint32_t Simulator::adcConversions = 0;
+
+static std::chrono::steady_clock::time_point wallStart;
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --seconds N         simulated duration (default 86400)\n"
+            "  --start ISO         RTC start time, YYYY-MM-DDTHH:MM:SS (default 2026-06-01T06:00:00)\n"
+            "  --script FILE       scenario: lines '<seconds> <channel> <value>'\n"
+            "                      channels: temp hum eco2 tvoc lux soil1 soil2 water <device>.online\n"
+            "                      <device>.stuck N - hold SDA low until N SCL clocks (255 - forever)\n"
+            "  --millis-offset MS  start the virtual clock at MS (wraparound tests)\n"
+            "  --loop-cost US      CPU time charged per loop() pass (default 20)\n"
+            "  --clock-ppm N       MCU clock error: millis() runs N ppm fast (negative - slow)\n"
+            "  --evaporation MM    water lost from the tank per day without the pump (default 0)\n"
+            "  --lcd-every S       print the LCD every S simulated seconds\n"
+            "  --input S:TEXT      feed TEXT + newline to Serial at S seconds\n"
+            "  --input-raw S:FILE  feed the bytes of FILE to Serial from S seconds, one per 40 ms\n"
+            "  --eeprom FILE       load/save the EEPROM image (persists across runs)\n"
+            "  --quiet             do not echo Serial output\n",
+            program);
+}
+
+static bool parseStart(const char* text, uint32_t& result)
+{
+    int year, month, day, hour, minute, second;
+    if (sscanf(text, "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6)
+    {
+        return false;
+    }
+    tmElements_t tm;
+    tm.Year = CalendarYrToTm(year);
+    tm.Month = month;
+    tm.Day = day;
+    tm.Hour = hour;
+    tm.Minute = minute;
+    tm.Second = second;
+    tm.Wday = 0;
+    result = static_cast<uint32_t>(makeTime(tm));
+    return true;
+}
+
+bool Simulator::configure(int argc, char** argv)
+{
+    registerSimDevices();
+
+    parseStart("2026-06-01T06:00:00", epoch);
+    env.soil[0] = 45.0;
+    env.soil[1] = 45.0;
+    env.waterMm = 250.0;
+
+    const char* script = nullptr;
+    const char* eepromImage = nullptr;
+    uint64_t millisOffset = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--quiet") == 0)
+        {
+            quietSerial = true;
+            continue;
+        }
+        if (value == nullptr)
+        {
+            usage(argv[0]);
+            return false;
+        }
+        i++;
+
+        if (strcmp(arg, "--seconds") == 0)
+        {
+            endUs = static_cast<uint64_t>(atof(value) * 1e6);
+        }
+        else if (strcmp(arg, "--start") == 0)
+        {
+            if (!parseStart(value, epoch))
+            {
+                usage(argv[0]);
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--eeprom") == 0)
+        {
+            eepromImage = value;
+        }
+        else if (strcmp(arg, "--script") == 0)
+        {
+            script = value;
+        }
+        else if (strcmp(arg, "--millis-offset") == 0)
+        {
+            millisOffset = strtoull(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--clock-ppm") == 0)
+        {
+            clockPpm = atoi(value);
+        }
+        else if (strcmp(arg, "--evaporation") == 0)
+        {
+            evaporationMmPerDay = atof(value);
+        }
+        else if (strcmp(arg, "--loop-cost") == 0)
+        {
+            loopCostUs = strtoull(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--lcd-every") == 0)
+        {
+            lcdEveryUs = static_cast<uint64_t>(atof(value) * 1e6);
+        }
+        else if (strcmp(arg, "--input") == 0)
+        {
+            const char* colon = strchr(value, ':');
+            if (colon == nullptr || inputCount >= MAX_INPUTS)
+            {
+                usage(argv[0]);
+                return false;
+            }
+            inputTimes[inputCount] = static_cast<uint64_t>(atof(value) * 1e6);
+            inputTexts[inputCount] = colon + 1;
+            inputCount++;
+        }
+        else if (strcmp(arg, "--input-raw") == 0)
+        {
+            const char* colon = strchr(value, ':');
+            FILE* raw = colon != nullptr ? fopen(colon + 1, "rb") : nullptr;
+            if (raw == nullptr)
+            {
+                usage(argv[0]);
+                return false;
+            }
+            rawInputStartUs = static_cast<uint64_t>(atof(value) * 1e6);
+            rawInputSize = static_cast<uint16_t>(fread(rawInput, 1, sizeof(rawInput), raw));
+            fclose(raw);
+        }
+        else
+        {
+            usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (script != nullptr && !loadScript(script))
+    {
+        return false;
+    }
+    if (!loadSimEeprom(eepromImage))
+    {
+        return false;
+    }
+
+    nowUs = millisOffset * 1000ULL;
+    startUs = nowUs;
+    lastPhysicsUs = nowUs;
+    lastLcdDumpUs = nowUs;
+    stepPhysics();
+
+    wallStart = std::chrono::steady_clock::now();
+    return true;
+}
+
+int Simulator::channelIndex(const char* name)
+{
+    for (uint8_t i = 0; i < sizeof(channelNames) / sizeof(channelNames[0]); i++)
+    {
+        if (strcmp(name, channelNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+
+    const char* dot = strchr(name, '.');
+    bool online = dot != nullptr && strcmp(dot, ".online") == 0;
+    bool stuck = dot != nullptr && strcmp(dot, ".stuck") == 0;
+    if (online || stuck)
+    {
+        for (uint8_t i = 0; i < deviceCount; i++)
+        {
+            if (strncmp(name, devices[i]->getName(), dot - name) == 0 &&
+                devices[i]->getName()[dot - name] == '\0')
+            {
+                return (online ? CH_ONLINE : CH_STUCK) + i;
+            }
+        }
+    }
+    return -1;
+}
+
+bool Simulator::loadScript(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "cannot open script %s\n", path);
+        return false;
+    }
+
+    char line[128];
+    unsigned lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        lineNumber++;
+        char* hash = strchr(line, '#');
+        if (hash != nullptr)
+        {
+            *hash = '\0';
+        }
+
+        double time;
+        char name[32];
+        double value;
+        int fields = sscanf(line, "%lf %31s %lf", &time, name, &value);
+        if (fields <= 0)
+        {
+            continue;
+        }
+
+        int channel = fields == 3 ? channelIndex(name) : -1;
+        if (channel < 0 || keyframeCount >= MAX_KEYFRAMES)
+        {
+            fprintf(stderr, "%s:%u: bad or unsupported line\n", path, lineNumber);
+            fclose(file);
+            return false;
+        }
+
+        // Вставка с сохранением порядка по времени
+        uint16_t pos = keyframeCount;
+        while (pos > 0 && keyframes[pos - 1].time > time)
+        {
+            keyframes[pos] = keyframes[pos - 1];
+            keyframeChannel[pos] = keyframeChannel[pos - 1];
+            pos--;
+        }
+        keyframes[pos].time = time;
+        keyframes[pos].value = value;
+        keyframeChannel[pos] = static_cast<uint8_t>(channel);
+        keyframeCount++;
+    }
+
+    fclose(file);
+    return true;
+}
+
+double Simulator::channelValue(uint8_t channel, double fallback)
+{
+    double t = elapsed() / 1e6;
+    const Keyframe* before = nullptr;
+    const Keyframe* after = nullptr;
+
+    for (uint16_t i = 0; i < keyframeCount; i++)
+    {
+        if (keyframeChannel[i] != channel)
+            continue;
+        if (keyframes[i].time <= t)
+        {
+            before = &keyframes[i];
+        }
+        else
+        {
+            after = &keyframes[i];
+            break;
+        }
+    }
+
+    if (before == nullptr && after == nullptr)
+        return fallback;
+    if (before == nullptr)
+        return after->value;
+    if (after == nullptr)
+        return before->value;
+
+    double k = (t - before->time) / (after->time - before->time);
+    return before->value + (after->value - before->value) * k;
+}
+
+void Simulator::stepPhysics()
+{
+    double dt = (nowUs - lastPhysicsUs) / 1e6;
+    double t = elapsed() / 1e6;
+    lastPhysicsUs = nowUs;
+
+    // Дискретные события сценария: уровни, влажность почвы, отказы устройств
+    while (keyframeApplied < keyframeCount && keyframes[keyframeApplied].time <= t)
+    {
+        uint8_t channel = keyframeChannel[keyframeApplied];
+        double value = keyframes[keyframeApplied].value;
+        if (channel == CH_SOIL_1)
+            env.soil[0] = value;
+        else if (channel == CH_SOIL_2)
+            env.soil[1] = value;
+        else if (channel == CH_WATER)
+            env.waterMm = value;
+        else if (channel >= CH_STUCK && channel - CH_STUCK < deviceCount)
+            devices[channel - CH_STUCK]->holdSda(static_cast<uint8_t>(value));
+        else if (channel >= CH_ONLINE && channel - CH_ONLINE < deviceCount)
+            devices[channel - CH_ONLINE]->setOnline(value != 0);
+        keyframeApplied++;
+    }
+
+    // Суточный ход, если сценарий не задает канал
+    double hour = fmod((epoch + t) / 3600.0, 24.0);
+    double daySine = sin(2.0 * M_PI * (hour - 9.0) / 24.0);
+    double daylight = (hour > 6.0 && hour < 20.0) ? 25000.0 * sin(M_PI * (hour - 6.0) / 14.0) : 0.0;
+
+    double fan = pinPwm[PIN_FAN] ? pinPwm[PIN_FAN] / 255.0 : (pinLevels[PIN_FAN] ? 1.0 : 0.0);
+    double lamp = pinPwm[PIN_LIGHT] ? pinPwm[PIN_LIGHT] / 255.0 : (pinLevels[PIN_LIGHT] ? 1.0 : 0.0);
+    bool pump = pinLevels[PIN_PUMP] != 0;
+
+    airExchange += (fan - airExchange) * (dt < AIR_EXCHANGE_TAU_S ? dt / AIR_EXCHANGE_TAU_S : 1.0);
+
+    double eco2 = channelValue(CH_ECO2, 650.0);
+    env.temperature = channelValue(CH_TEMP, 24.0 + 6.0 * daySine) - 3.0 * airExchange;
+    env.humidity = channelValue(CH_HUM, 65.0 - 15.0 * daySine) - 15.0 * airExchange;
+    env.eco2 = eco2 - (eco2 - 420.0) * 0.5 * airExchange;
+    env.tvoc = channelValue(CH_TVOC, 120.0);
+    env.lux = channelValue(CH_LUX, daylight) + LAMP_LUX * lamp;
+
+    double delivered = 0.0;
+    if (pump && env.waterMm > 0.0)
+    {
+        double head = env.waterMm / TANK_HEIGHT_MM;
+        delivered = (PUMP_ML_PER_MIN_EMPTY + (PUMP_ML_PER_MIN_FULL - PUMP_ML_PER_MIN_EMPTY) * head) / 60.0 * dt;
+        env.waterMm -= delivered * 1000.0 / TANK_AREA_MM2;
+    }
+    env.waterMm -= evaporationMmPerDay * dt / 86400.0;
+    if (env.waterMm < 0.0)
+        env.waterMm = 0.0;
+    soilPoolMl += delivered;
+    if (soilPoolMl > SOIL_POOL_MAX_ML)
+    {
+        runoffMl += soilPoolMl - SOIL_POOL_MAX_ML;
+        soilPoolMl = SOIL_POOL_MAX_ML;
+    }
+    double soaked = soilPoolMl * (dt < SOIL_SOAK_TAU_S ? dt / SOIL_SOAK_TAU_S : 1.0);
+    soilPoolMl -= soaked;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        env.soil[i] += soaked * SOIL_PERCENT_PER_ML - SOIL_DRY_PERCENT_PER_S * dt;
+        env.soil[i] = env.soil[i] < 0.0 ? 0.0 : (env.soil[i] > 100.0 ? 100.0 : env.soil[i]);
+    }
+
+    uint64_t dtUs = static_cast<uint64_t>(dt * 1e6);
+    if (lamp > 0.0)
+        actuatorOnUs[0] += dtUs;
+    lampEnergyS += lamp * dt;
+    plantLightLuxS += env.lux * dt;
+    if (fan > 0.0)
+        actuatorOnUs[1] += dtUs;
+    if (pump)
+        actuatorOnUs[2] += dtUs;
+}
+
+void Simulator::advance(uint64_t us)
+{
+    uint64_t target = nowUs + us;
+
+    for (;;)
+    {
+        int8_t next = -1;
+        for (uint8_t i = 0; i < eventCount; i++)
+        {
+            if (events[i].time <= target && (next < 0 || events[i].time < events[next].time))
+            {
+                next = i;
+            }
+        }
+
+        uint64_t adcAt = nextAdcCompletion();
+        if (adcAt != 0 && adcAt <= target && (next < 0 || adcAt < events[next].time))
+        {
+            if (adcAt > nowUs)
+            {
+                nowUs = adcAt;
+            }
+            completeAdc();
+            continue;
+        }
+
+        if (next < 0)
+            break;
+
+        PinEvent event = events[next];
+        events[next] = events[--eventCount];
+        if (event.time > nowUs)
+        {
+            nowUs = event.time;
+        }
+        applyPin(event.pin, event.level);
+    }
+
+    nowUs = target;
+    if (nowUs - lastPhysicsUs >= PHYSICS_STEP_US)
+    {
+        stepPhysics();
+    }
+}
+
+void Simulator::schedule(uint64_t time, uint8_t pin, uint8_t level)
+{
+    if (eventCount < MAX_EVENTS)
+    {
+        events[eventCount].time = time;
+        events[eventCount].pin = pin;
+        events[eventCount].level = level;
+        eventCount++;
+    }
+}
+
+void Simulator::setPinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= NUM_PINS)
+        return;
+
+    // Отпущенная SCL (открытый сток) - такт для ведомого, держащего SDA
+    if (pin == PIN_SCL && pinModes[pin] == OUTPUT && mode != OUTPUT && pinLevels[pin] == LOW)
+    {
+        for (uint8_t i = 0; i < deviceCount; i++)
+        {
+            devices[i]->clockScl();
+        }
+    }
+    pinModes[pin] = mode;
+}
+
+void Simulator::applyPin(uint8_t pin, uint8_t level)
+{
+    if (pin >= NUM_PINS || pinLevels[pin] == level)
+        return;
+
+    pinLevels[pin] = level;
+    uint8_t port = digitalPinToPort(pin);
+    uint8_t mask = digitalPinToBitMask(pin);
+    if (level)
+        portInput[port] |= mask;
+    else
+        portInput[port] &= ~mask;
+
+    raisePinChange(pin);
+}
+
+void Simulator::writePin(uint8_t pin, uint8_t level)
+{
+    if (pin >= NUM_PINS)
+        return;
+
+    level = level ? HIGH : LOW;
+    uint8_t previous = pinLevels[pin];
+    pinPwm[pin] = 0;
+    applyPin(pin, level);
+
+    if (previous != level)
+    {
+        if (pin == PIN_LIGHT)
+            actuatorToggles[0]++;
+        else if (pin == PIN_FAN)
+            actuatorToggles[1]++;
+        else if (pin == PIN_PUMP)
+            actuatorToggles[2]++;
+    }
+
+    // HC-SR04: по спаду TRIG (>=10 мкс) через ~460 мкс приходит эхо
+    if (pin == PIN_TRIG)
+    {
+        if (level == HIGH)
+        {
+            trigHighAt = nowUs;
+        }
+        else if (previous == HIGH && nowUs - trigHighAt >= 10)
+        {
+            double distanceMm = TANK_HEIGHT_MM - env.waterMm;
+            uint64_t width = static_cast<uint64_t>(distanceMm * 5.8);
+            schedule(nowUs + 460, PIN_ECHO, HIGH);
+            schedule(nowUs + 460 + width, PIN_ECHO, LOW);
+        }
+    }
+}
+
+uint8_t Simulator::readPin(uint8_t pin)
+{
+    if (pin >= NUM_PINS)
+        return LOW;
+
+    // Линии I2C подтянуты резисторами: ноль, только если их кто-то прижимает
+    if (pin == PIN_SDA || pin == PIN_SCL)
+    {
+        bool driven = pinModes[pin] == OUTPUT && pinLevels[pin] == LOW;
+        return driven || (pin == PIN_SDA && busHeld()) ? LOW : HIGH;
+    }
+    return pinLevels[pin];
+}
+
+void Simulator::writePwm(uint8_t pin, uint8_t duty)
+{
+    if (pin >= NUM_PINS)
+        return;
+
+    bool wasOn = pinPwm[pin] > 0 || pinLevels[pin];
+    if (duty == 0 || duty == 255)
+    {
+        writePin(pin, duty ? HIGH : LOW);
+        return;
+    }
+    pinPwm[pin] = duty;
+    applyPin(pin, HIGH);
+    if (!wasOn)
+    {
+        if (pin == PIN_LIGHT)
+            actuatorToggles[0]++;
+        else if (pin == PIN_FAN)
+            actuatorToggles[1]++;
+    }
+}
+
+int Simulator::readAnalog(uint8_t pin)
+{
+    // Емкостный датчик почвы: 470 - сухо, 200 - мокро, плюс шум АЦП
+    double soil;
+    if (pin == PIN_SOIL_1)
+        soil = env.soil[0];
+    else if (pin == PIN_SOIL_2)
+        soil = env.soil[1];
+    else
+        return 0;
+
+    int raw = static_cast<int>(470.0 - soil * 2.7) + (rand() % 7) - 3;
+    return constrain(raw, 0, 1023);
+}
+
+void Simulator::raisePinChange(uint8_t pin)
+{
+    uint8_t group = pin < 8 ? 2 : (pin < 14 ? 0 : 1);
+    volatile uint8_t* mask = digitalPinToPCMSK(pin);
+    if (!(PCICR & (1 << group)) || !(*mask & (1 << digitalPinToPCMSKbit(pin))))
+        return;
+
+    if (!interruptsEnabled)
+    {
+        pcintPending |= 1 << group;
+        return;
+    }
+
+    if (group == 0 && PCINT0_vect)
+        PCINT0_vect();
+    else if (group == 1 && PCINT1_vect)
+        PCINT1_vect();
+    else if (group == 2 && PCINT2_vect)
+        PCINT2_vect();
+}
+
+uint64_t Simulator::nextAdcCompletion()
+{
+    // Автозапуск по переполнению Timer0 с прерыванием по готовности
+    const uint8_t mask = _BV(ADEN) | _BV(ADATE) | _BV(ADIE);
+    if ((ADCSRA & mask) != mask || (ADCSRB & 0x07) != _BV(ADTS2))
+    {
+        adcNextUs = 0;
+        return 0;
+    }
+    if (adcNextUs == 0)
+    {
+        adcNextUs = (nowUs / TIMER0_OVERFLOW_US + 1) * TIMER0_OVERFLOW_US + ADC_CONVERSION_US;
+    }
+    return adcNextUs;
+}
+
+void Simulator::completeAdc()
+{
+    adcNextUs += TIMER0_OVERFLOW_US;
+    adcConversions++;
+    ADC = static_cast<uint16_t>(readAnalog(A0 + (ADMUX & 0x07)));
+
+    if (!interruptsEnabled)
+    {
+        adcPending = true;
+        return;
+    }
+    if (ADC_vect)
+        ADC_vect();
+}
+
+void Simulator::setInterrupts(bool enabled)
+{
+    interruptsEnabled = enabled;
+    if (enabled && adcPending)
+    {
+        adcPending = false;
+        if (ADC_vect)
+            ADC_vect();
+    }
+    if (!enabled || pcintPending == 0)
+        return;
+
+    uint8_t pending = pcintPending;
+    pcintPending = 0;
+    if ((pending & 0x01) && PCINT0_vect)
+        PCINT0_vect();
+    if ((pending & 0x02) && PCINT1_vect)
+        PCINT1_vect();
+    if ((pending & 0x04) && PCINT2_vect)
+        PCINT2_vect();
+}
+
+void Simulator::addDevice(SimI2CDevice* device)
+{
+    if (deviceCount < MAX_DEVICES)
+    {
+        devices[deviceCount++] = device;
+    }
+}
+
+SimI2CDevice* Simulator::findDevice(uint8_t address)
+{
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        if (devices[i]->getAddress() == address)
+        {
+            return devices[i];
+        }
+    }
+    return nullptr;
+}
+
+bool Simulator::busHeld()
+{
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        if (devices[i]->isHoldingSda())
+            return true;
+    }
+    return false;
+}
+
+void Simulator::hang(const char* reason)
+{
+    fprintf(stderr, "[t=%.3fs] MCU hung: %s\n", elapsed() / 1e6, reason);
+    if (elapsed() < endUs)
+    {
+        advance(endUs - elapsed());
+    }
+}
+
+void Simulator::chargeBus(uint8_t bytes)
+{
+    // 9 тактов на байт (с ACK) плюс START/STOP
+    uint64_t bits = static_cast<uint64_t>(bytes) * 9 + 2;
+    advance((bits * 1000000ULL + busClockHz - 1) / busClockHz);
+}
+
+bool Simulator::finished()
+{
+    return elapsed() >= endUs;
+}
+
+void Simulator::endLoopPass(uint64_t passStartUs)
+{
+    advance(loopCostUs);
+
+    uint64_t pass = nowUs - passStartUs;
+    loopPasses++;
+    loopTotalUs += pass;
+    if (pass > loopMaxUs)
+    {
+        loopMaxUs = pass;
+    }
+
+    while (inputDelivered < inputCount && inputTimes[inputDelivered] <= elapsed())
+    {
+        for (const char* c = inputTexts[inputDelivered]; *c; c++)
+        {
+            Serial.inject(*c);
+        }
+        Serial.inject('\n');
+        inputDelivered++;
+    }
+
+    // Сырые байты идут с паузой, как их шлет tools/rule_compile
+    while (rawInputDelivered < rawInputSize &&
+           rawInputStartUs + rawInputDelivered * RAW_INPUT_GAP_US <= elapsed())
+    {
+        Serial.inject(rawInput[rawInputDelivered++]);
+    }
+
+    if (lcdEveryUs != 0 && nowUs - lastLcdDumpUs >= lcdEveryUs)
+    {
+        lastLcdDumpUs = nowUs;
+        dumpLcd(stderr);
+    }
+}
+
+void Simulator::dumpLcd(FILE* out)
+{
+    const SimLcd& lcd = simLcd();
+    fprintf(out, "[lcd t=%.3fs backlight=%s]\n", elapsed() / 1e6, lcd.backlight ? "on" : "off");
+    lcd.dump(out);
+}
+
+void Simulator::report()
+{
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double simulated = elapsed() / 1e6;
+
+    fprintf(stderr, "\n--- simulation report ---\n");
+    fprintf(stderr, "simulated %.1f s in %.3f s wall (x%.0f)\n", simulated, wall, wall > 0 ? simulated / wall : 0.0);
+    fprintf(stderr, "loop passes %llu, mean %.1f us, max %llu us\n",
+            static_cast<unsigned long long>(loopPasses),
+            loopPasses ? static_cast<double>(loopTotalUs) / loopPasses : 0.0,
+            static_cast<unsigned long long>(loopMaxUs));
+
+    fprintf(stderr, "adc conversions %lu\n", static_cast<unsigned long>(adcConversions));
+    fprintf(stderr, "i2c @ %lu Hz at exit:\n", static_cast<unsigned long>(busClockHz));
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        const SimI2CDevice* d = devices[i];
+        fprintf(stderr, "  %-9s 0x%02X  max %3lu kHz  transactions %-9lu bytes %-10lu nacks %lu"
+                "  overclocked %lu  timeouts %lu\n", d->getName(), d->getAddress(),
+                static_cast<unsigned long>(d->maxClockHz / 1000), static_cast<unsigned long>(d->transactions),
+                static_cast<unsigned long>(d->bytes), static_cast<unsigned long>(d->nacks),
+                static_cast<unsigned long>(d->overclocked), static_cast<unsigned long>(d->timeouts));
+    }
+
+    static const char* const actuators[3] = {"light", "fan", "pump"};
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        fprintf(stderr, "%-5s on %.0f s, switched on %lu times\n", actuators[i], actuatorOnUs[i] / 1e6,
+                static_cast<unsigned long>(actuatorToggles[i]));
+    }
+    fprintf(stderr, "environment: %.1f C, %.1f %%RH, %.0f ppm, %.0f lx, soil %.1f/%.1f %%, water %.1f mm\n",
+            env.temperature, env.humidity, env.eco2, env.lux, env.soil[0], env.soil[1], env.waterMm);
+    fprintf(stderr, "irrigation runoff %.0f ml\n", runoffMl);
+    fprintf(stderr, "lamp energy %.2f full-power hours, light integral %.2f mol/m2 (at 54 lx per umol/m2/s)\n",
+            lampEnergyS / 3600.0, plantLightLuxS / 54.0 / 1e6);
+
+    reportSimEeprom(stderr);
+    saveSimEeprom();
+
+    dumpLcd(stderr);
+}
@@ -0,0 +1,211 @@
+#ifndef NATIVE_SIMULATOR_H
+#define NATIVE_SIMULATOR_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Модель устройства на шине I2C. Адрес не отвечает (NACK), пока устройство offline
+// или пока частота шины выше той, что оно держит.
+class SimI2CDevice
+{
+private:
+    uint8_t address;
+    const char* name;
+    bool online;
+    uint8_t stuckClocks;  // держит SDA, пока не получит столько тактов SCL
+
+public:
+    static const uint8_t STUCK_FOREVER = 255;
+
+    uint32_t maxClockHz;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t nacks;
+    uint32_t overclocked;
+    uint32_t timeouts;
+
+    SimI2CDevice(uint8_t address, const char* name, uint32_t maxClockHz = 400000);
+    virtual ~SimI2CDevice() {}
+
+    uint8_t getAddress() const { return address; }
+    const char* getName() const { return name; }
+    bool isOnline() const { return online; }
+    void setOnline(bool state) { online = state; }
+
+    // Ведомый, сброшенный посреди байта, прижимает SDA к земле
+    void holdSda(uint8_t clocks) { stuckClocks = clocks; }
+    bool isHoldingSda() const { return stuckClocks != 0; }
+    void clockScl()
+    {
+        if (stuckClocks != 0 && stuckClocks != STUCK_FOREVER)
+            stuckClocks--;
+    }
+
+    // Запись от мастера: data[0..len)
+    virtual void onWrite(const uint8_t* data, uint8_t len) = 0;
+    // Чтение мастером: заполнить до len байт, вернуть сколько отдали
+    virtual uint8_t onRead(uint8_t* data, uint8_t len) = 0;
+};
+
+// Состояние "теплицы", которое видят датчики
+struct SimEnvironment
+{
+    double temperature;   // °C
+    double humidity;      // %
+    double eco2;          // ppm
+    double tvoc;          // ppb
+    double lux;
+    double soil[2];       // влажность почвы, %
+    double waterMm;       // уровень воды в баке, мм
+};
+
+// Виртуальное время, выводы, шина и сценарий. Все статическое: симулятор один.
+class Simulator
+{
+public:
+    // Разводка платы (как в main.h / SensorManager.h)
+    static const uint8_t PIN_FAN = 5;
+    static const uint8_t PIN_LIGHT = 6;
+    static const uint8_t PIN_PUMP = 7;
+    static const uint8_t PIN_TRIG = 11;
+    static const uint8_t PIN_ECHO = 12;
+    static const uint8_t PIN_SOIL_1 = 14;
+    static const uint8_t PIN_SOIL_2 = 15;
+    static const uint8_t PIN_SDA = 18;
+    static const uint8_t PIN_SCL = 19;
+
+    static const uint8_t NUM_PINS = 20;
+    static const uint8_t MAX_DEVICES = 8;
+
+    static volatile uint8_t portInput[3];
+
+    static bool configure(int argc, char** argv);
+    static bool finished();
+    static void endLoopPass(uint64_t passStartUs);
+    static void report();
+
+    // Время
+    static uint64_t now() { return nowUs; }
+    // Время от запуска симуляции (now() может стартовать со сдвигом)
+    static uint64_t elapsed() { return nowUs - startUs; }
+    // Время по кварцу МК (millis/micros): уходит на clockPpm относительно реального
+    static uint64_t cpuTime() { return startUs + elapsed() + static_cast<int64_t>(elapsed()) * clockPpm / 1000000; }
+    static void advance(uint64_t us);
+
+    // Выводы
+    static void setPinMode(uint8_t pin, uint8_t mode);
+    static void writePin(uint8_t pin, uint8_t level);
+    static uint8_t readPin(uint8_t pin);
+    static void writePwm(uint8_t pin, uint8_t duty);
+    static int readAnalog(uint8_t pin);
+
+    // Прерывания
+    static void setInterrupts(bool enabled);
+
+    // Шина I2C
+    static void addDevice(SimI2CDevice* device);
+    static SimI2CDevice* findDevice(uint8_t address);
+    static void setBusClock(uint32_t hz) { busClockHz = hz; }
+    static void chargeBus(uint8_t bytes);
+    static uint32_t getBusClock() { return busClockHz; }
+    // SDA прижата к земле одним из ведомых
+    static bool busHeld();
+    // Обмен без таймаута на занятой шине: МК висит до конца симуляции
+    static void hang(const char* reason);
+
+    static const SimEnvironment& environment() { return env; }
+    static uint32_t startEpoch() { return epoch; }
+    static bool quiet() { return quietSerial; }
+
+private:
+    struct PinEvent
+    {
+        uint64_t time;
+        uint8_t pin;
+        uint8_t level;
+    };
+
+    struct Keyframe
+    {
+        double time;
+        double value;
+    };
+
+    static const uint8_t MAX_EVENTS = 8;
+    static const uint8_t MAX_INPUTS = 16;
+    static const uint16_t MAX_KEYFRAMES = 256;
+    static const uint16_t MAX_RAW_INPUT = 512;
+    static const uint64_t RAW_INPUT_GAP_US = 40000;
+
+    static uint64_t nowUs;
+    static uint64_t startUs;
+    static uint64_t endUs;
+    static uint64_t loopCostUs;
+    static uint64_t lcdEveryUs;
+    static uint64_t lastLcdDumpUs;
+    static uint64_t lastPhysicsUs;
+    static uint64_t trigHighAt;
+    static uint32_t busClockHz;
+    static uint32_t epoch;
+    static int32_t clockPpm;
+    static double evaporationMmPerDay;  // убыль воды из бака без насоса
+    static bool quietSerial;
+    static bool interruptsEnabled;
+    static uint8_t pcintPending;  // отложенные PCINT по группам, пока прерывания запрещены
+    static bool adcPending;
+    static uint64_t adcNextUs;    // окончание следующего преобразования, 0 - не запланировано
+
+    static uint8_t pinModes[NUM_PINS];
+    static uint8_t pinLevels[NUM_PINS];
+    static uint8_t pinPwm[NUM_PINS];
+
+    static PinEvent events[MAX_EVENTS];
+    static uint8_t eventCount;
+
+    static SimI2CDevice* devices[MAX_DEVICES];
+    static uint8_t deviceCount;
+
+    static SimEnvironment env;
+    static double airExchange;  // 0..1, доля воздуха, которую успевает сменить вентилятор
+    static double soilPoolMl;   // вода на поверхности, еще не впиталась
+    static double runoffMl;     // стекло мимо корней
+    static double lampEnergyS;  // работа лампы в пересчете на полную мощность
+    static double plantLightLuxS;
+
+    // Сценарий: каналы с ключевыми кадрами
+    static Keyframe keyframes[MAX_KEYFRAMES];
+    static uint8_t keyframeChannel[MAX_KEYFRAMES];
+    static uint16_t keyframeCount;
+    static uint16_t keyframeApplied;
+
+    static uint64_t inputTimes[MAX_INPUTS];
+    static const char* inputTexts[MAX_INPUTS];
+    static uint8_t inputCount;
+    static uint8_t inputDelivered;
+
+    static uint8_t rawInput[MAX_RAW_INPUT];
+    static uint16_t rawInputSize;
+    static uint16_t rawInputDelivered;
+    static uint64_t rawInputStartUs;
+
+    // Статистика
+    static uint64_t loopPasses;
+    static uint64_t loopMaxUs;
+    static uint64_t loopTotalUs;
+    static uint64_t actuatorOnUs[3];
+    static uint32_t actuatorToggles[3];
+    static uint32_t adcConversions;
+
+    static void schedule(uint64_t time, uint8_t pin, uint8_t level);
+    static void applyPin(uint8_t pin, uint8_t level);
+    static void raisePinChange(uint8_t pin);
+    static uint64_t nextAdcCompletion();
+    static void completeAdc();
+    static void stepPhysics();
+    static double channelValue(uint8_t channel, double fallback);
+    static bool loadScript(const char* path);
+    static int channelIndex(const char* name);
+    static void dumpLcd(FILE* out);
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "TimeLib.h"
+
+static const uint8_t monthDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static bool leapYear(int year)
+{
+    return (year > 0) && !(year % 4) && ((year % 100) || !(year % 400));
+}
+
+time_t makeTime(const tmElements_t& tm)
+{
+    uint32_t seconds = tm.Year * (SECS_PER_DAY * 365);
+    for (int i = 0; i < tm.Year; i++)
+    {
+        if (leapYear(1970 + i))
+        {
+            seconds += SECS_PER_DAY;
+        }
+    }
+
+    for (int i = 1; i < tm.Month; i++)
+    {
+        if (i == 2 && leapYear(1970 + tm.Year))
+        {
+            seconds += SECS_PER_DAY * 29;
+        }
+        else
+        {
+            seconds += SECS_PER_DAY * monthDays[i - 1];
+        }
+    }
+    seconds += (tm.Day - 1) * SECS_PER_DAY;
+    seconds += tm.Hour * SECS_PER_HOUR;
+    seconds += tm.Minute * SECS_PER_MIN;
+    seconds += tm.Second;
+    return static_cast<time_t>(seconds);
+}
+
+void breakTime(time_t timeInput, tmElements_t& tm)
+{
+    uint32_t time = static_cast<uint32_t>(timeInput);
+    tm.Second = time % 60;
+    time /= 60;
+    tm.Minute = time % 60;
+    time /= 60;
+    tm.Hour = time % 24;
+    time /= 24;
+    tm.Wday = ((time + 4) % 7) + 1;
+
+    uint8_t year = 0;
+    uint32_t days = 0;
+    while ((days += (leapYear(1970 + year) ? 366 : 365)) <= time)
+    {
+        year++;
+    }
+    tm.Year = year;
+
+    days -= leapYear(1970 + year) ? 366 : 365;
+    time -= days;
+
+    uint8_t month;
+    uint8_t monthLength = 0;
+    for (month = 0; month < 12; month++)
+    {
+        if (month == 1)
+        {
+            monthLength = leapYear(1970 + year) ? 29 : 28;
+        }
+        else
+        {
+            monthLength = monthDays[month];
+        }
+
+        if (time >= monthLength)
+        {
+            time -= monthLength;
+        }
+        else
+        {
+            break;
+        }
+    }
+    tm.Month = month + 1;
+    tm.Day = time + 1;
+}
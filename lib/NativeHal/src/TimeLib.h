@@ -0,0 +1,32 @@
+#ifndef NATIVE_TIMELIB_H
+#define NATIVE_TIMELIB_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Подмножество библиотеки Time (PaulStoffregen) для сборки под хост
+
+typedef struct
+{
+    uint8_t Second;
+    uint8_t Minute;
+    uint8_t Hour;
+    uint8_t Wday;   // 1 - воскресенье
+    uint8_t Day;
+    uint8_t Month;
+    uint8_t Year;   // от 1970
+} tmElements_t, TimeElements, *tmElementsPtr_t;
+
+#define tmYearToCalendar(Y) ((Y) + 1970)
+#define CalendarYrToTm(Y) ((Y) - 1970)
+#define tmYearToY2k(Y) ((Y) - 30)
+#define y2kYearToTm(Y) ((Y) + 30)
+
+#define SECS_PER_MIN ((time_t)(60UL))
+#define SECS_PER_HOUR ((time_t)(3600UL))
+#define SECS_PER_DAY ((time_t)(SECS_PER_HOUR * 24UL))
+
+time_t makeTime(const tmElements_t& tm);
+void breakTime(time_t time, tmElements_t& tm);
+
+#endif
@@ -0,0 +1,165 @@
+#include "Wire.h"
+#include "Simulator.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire()
+{
+    txAddress = 0;
+    txLength = 0;
+    transmitting = false;
+    rxIndex = 0;
+    rxLength = 0;
+    timeoutUs = 0;
+    timeoutFlag = false;
+}
+
+void TwoWire::begin()
+{
+    Simulator::setBusClock(100000);
+}
+
+void TwoWire::setClock(uint32_t clock)
+{
+    Simulator::setBusClock(clock);
+}
+
+void TwoWire::setWireTimeout(uint32_t timeout, bool resetWithTimeout)
+{
+    (void)resetWithTimeout;
+    timeoutUs = timeout;
+    timeoutFlag = false;
+}
+
+uint8_t TwoWire::access(SimI2CDevice* device)
+{
+    if (Simulator::busHeld())
+    {
+        if (timeoutUs == 0)
+        {
+            Simulator::hang("I2C START with SDA held low, no Wire timeout");
+        }
+        else
+        {
+            Simulator::advance(timeoutUs);
+        }
+        timeoutFlag = true;
+        if (device != nullptr)
+        {
+            device->timeouts++;
+        }
+        return 5;
+    }
+
+    if (device == nullptr || !device->isOnline())
+    {
+        Simulator::chargeBus(1);
+        if (device != nullptr)
+        {
+            device->nacks++;
+        }
+        return 2;  // NACK на адрес
+    }
+
+    // Медленный ведомый не успевает за тактами и не отвечает
+    if (Simulator::getBusClock() > device->maxClockHz)
+    {
+        Simulator::chargeBus(1);
+        device->overclocked++;
+        return 2;
+    }
+    return 0;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    transmitting = true;
+    txAddress = address;
+    txLength = 0;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t sendStop)
+{
+    (void)sendStop;
+    transmitting = false;
+
+    SimI2CDevice* device = Simulator::findDevice(txAddress);
+    uint8_t status = access(device);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    device->transactions++;
+    device->bytes += txLength + 1;
+    device->onWrite(txBuffer, txLength);
+    Simulator::chargeBus(txLength + 1);
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop)
+{
+    (void)sendStop;
+    rxIndex = 0;
+    rxLength = 0;
+
+    if (quantity > BUFFER_LENGTH)
+    {
+        quantity = BUFFER_LENGTH;
+    }
+
+    SimI2CDevice* device = Simulator::findDevice(address);
+    if (access(device) != 0)
+    {
+        return 0;
+    }
+
+    device->transactions++;
+    device->bytes += quantity + 1;
+    rxLength = device->onRead(rxBuffer, quantity);
+    Simulator::chargeBus(quantity + 1);
+    return rxLength;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (!transmitting || txLength >= BUFFER_LENGTH)
+    {
+        return 0;
+    }
+    txBuffer[txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < quantity; i++)
+    {
+        n += write(data[i]);
+    }
+    return n;
+}
+
+int TwoWire::available()
+{
+    return rxLength - rxIndex;
+}
+
+int TwoWire::read()
+{
+    if (rxIndex >= rxLength)
+    {
+        return -1;
+    }
+    return rxBuffer[rxIndex++];
+}
+
+int TwoWire::peek()
+{
+    if (rxIndex >= rxLength)
+    {
+        return -1;
+    }
+    return rxBuffer[rxIndex];
+}
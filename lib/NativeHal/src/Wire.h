@@ -0,0 +1,70 @@
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Как в ядре AVR 1.8.2+: setWireTimeout() и флаг таймаута
+#define WIRE_HAS_TIMEOUT
+
+class SimI2CDevice;
+
+// TwoWire поверх моделей устройств симулятора. Время передачи каждого
+// байта списывается с виртуальных часов по текущей частоте шины.
+// Пока ведомый держит SDA, обмен ждет таймаута, а без таймаута зависает.
+class TwoWire
+{
+public:
+    static const uint8_t BUFFER_LENGTH = 32;
+
+private:
+    uint8_t txAddress;
+    uint8_t txBuffer[BUFFER_LENGTH];
+    uint8_t txLength;
+    bool transmitting;
+
+    uint8_t rxBuffer[BUFFER_LENGTH];
+    uint8_t rxIndex;
+    uint8_t rxLength;
+
+    uint32_t timeoutUs;
+    bool timeoutFlag;
+
+    // 0 - можно обмениваться, иначе код ошибки endTransmission()
+    uint8_t access(SimI2CDevice* device);
+
+public:
+    TwoWire();
+
+    void begin();
+    void end() {}
+    void setClock(uint32_t clock);
+    void setWireTimeout(uint32_t timeout = 25000, bool resetWithTimeout = false);
+    bool getWireTimeoutFlag() const { return timeoutFlag; }
+    void clearWireTimeoutFlag() { timeoutFlag = false; }
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission(static_cast<uint8_t>(address)); }
+    uint8_t endTransmission(uint8_t sendStop);
+    uint8_t endTransmission() { return endTransmission(static_cast<uint8_t>(true)); }
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) { return requestFrom(address, quantity, static_cast<uint8_t>(true)); }
+    uint8_t requestFrom(int address, int quantity) { return requestFrom(static_cast<uint8_t>(address), static_cast<uint8_t>(quantity), static_cast<uint8_t>(true)); }
+    uint8_t requestFrom(int address, int quantity, int sendStop)
+    {
+        return requestFrom(static_cast<uint8_t>(address), static_cast<uint8_t>(quantity), static_cast<uint8_t>(sendStop));
+    }
+
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t quantity);
+    size_t write(int data) { return write(static_cast<uint8_t>(data)); }
+
+    int available();
+    int read();
+    int peek();
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef NATIVE_AVR_EEPROM_H
+#define NATIVE_AVR_EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// EEPROM ATmega328P: 1 КБ, запись байта ~3.4 мс виртуального времени.
+// Запись при занятой EEPROM ждет, как eeprom_write_byte в avr-libc.
+#define E2END 0x3FF
+
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_write_byte(uint8_t* addr, uint8_t value);
+void eeprom_update_byte(uint8_t* addr, uint8_t value);
+void eeprom_read_block(void* dst, const void* src, size_t n);
+void eeprom_update_block(const void* src, void* dst, size_t n);
+bool eeprom_is_ready();
+
+#endif
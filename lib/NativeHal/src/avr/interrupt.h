@@ -0,0 +1,13 @@
+#ifndef NATIVE_AVR_INTERRUPT_H
+#define NATIVE_AVR_INTERRUPT_H
+
+// Обработчик прерывания - обычная функция, симулятор вызывает ее сам
+#define ISR(vector, ...) extern "C" void vector(void)
+
+void noInterrupts();
+void interrupts();
+
+#define cli() noInterrupts()
+#define sei() interrupts()
+
+#endif
@@ -0,0 +1,23 @@
+#include "Arduino.h"
+#include "Simulator.h"
+
+// Точка входа сборки под хост: setup()/loop() прошивки без изменений,
+// время виртуальное и идет быстрее реального
+int main(int argc, char** argv)
+{
+    if (!Simulator::configure(argc, argv))
+    {
+        return 1;
+    }
+
+    setup();
+    while (!Simulator::finished())
+    {
+        uint64_t passStart = Simulator::now();
+        loop();
+        Simulator::endLoopPass(passStart);
+    }
+
+    Simulator::report();
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "AHT20Async.h"
+
+AHT20Async::AHT20Async()
+{
+    state = STATE_IDLE;
+    triggerTime = 0;
+    rawHumidity = 0;
+    rawTemperature = 0;
+}
+
+bool AHT20Async::begin()
+{
+    int16_t status = readStatus();
+    if (status < 0)
+    {
+        return false;
+    }
+
+    if (!(status & STATUS_CALIBRATED))
+    {
+        // Загрузка калибровочных коэффициентов, нужна один раз после подачи питания
+        if (!writeCommand(CMD_INIT, 0x08, 0x00))
+        {
+            return false;
+        }
+        delay(10);
+        status = readStatus();
+        if (status < 0 || !(status & STATUS_CALIBRATED))
+        {
+            return false;
+        }
+    }
+
+    state = STATE_IDLE;
+    return true;
+}
+
+bool AHT20Async::trigger()
+{
+    if (state == STATE_MEASURING)
+    {
+        return true;
+    }
+
+    if (!writeCommand(CMD_TRIGGER, 0x33, 0x00))
+    {
+        state = STATE_ERROR;
+        return false;
+    }
+
+    triggerTime = millis();
+    state = STATE_MEASURING;
+    return true;
+}
+
+AHT20Async::State AHT20Async::poll()
+{
+    if (state != STATE_MEASURING)
+    {
+        return state;
+    }
+
+    uint32_t elapsed = millis() - triggerTime;
+    if (elapsed < MEASUREMENT_TIME_MS)
+    {
+        return state;
+    }
+
+    uint8_t frame[FRAME_SIZE];
+    if (!I2cBus::read(I2cBus::DEV_AHT20, frame, FRAME_SIZE))
+    {
+        state = STATE_ERROR;
+        return state;
+    }
+
+    if (frame[0] & STATUS_BUSY)
+    {
+        if (elapsed > MEASUREMENT_TIMEOUT_MS)
+        {
+            state = STATE_ERROR;
+        }
+        return state;
+    }
+
+    if (crc8(frame, FRAME_SIZE - 1) != frame[FRAME_SIZE - 1])
+    {
+        state = STATE_ERROR;
+        return state;
+    }
+
+    // 20 бит влажности, затем 20 бит температуры
+    rawHumidity = (static_cast<uint32_t>(frame[1]) << 12) | (static_cast<uint32_t>(frame[2]) << 4) | (frame[3] >> 4);
+    rawTemperature = (static_cast<uint32_t>(frame[3] & 0x0F) << 16) | (static_cast<uint32_t>(frame[4]) << 8) | frame[5];
+
+    state = STATE_READY;
+    return state;
+}
+
+// T = raw / 2^20 * 200 - 50, в десятых долях и с округлением
+DeciCelsius AHT20Async::getTemperature() const
+{
+    return DeciCelsius::fromRaw(static_cast<int16_t>(((rawTemperature * 2000UL + (1UL << 19)) >> 20) - 500));
+}
+
+// RH = raw / 2^20 * 100
+DeciPercent AHT20Async::getHumidity() const
+{
+    return DeciPercent::fromRaw(static_cast<uint16_t>((rawHumidity * 1000UL + (1UL << 19)) >> 20));
+}
+
+bool AHT20Async::writeCommand(uint8_t cmd, uint8_t arg1, uint8_t arg2)
+{
+    uint8_t command[3] = {cmd, arg1, arg2};
+    return I2cBus::write(I2cBus::DEV_AHT20, command, sizeof(command));
+}
+
+int16_t AHT20Async::readStatus()
+{
+    uint8_t status;
+    if (!I2cBus::read(I2cBus::DEV_AHT20, &status, 1))
+    {
+        return -1;
+    }
+    return status;
+}
+
+uint8_t AHT20Async::crc8(const uint8_t* data, uint8_t len)
+{
+    // CRC-8, полином 0x31, начальное значение 0xFF (по даташиту AHT20)
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,60 @@
+#ifndef AHT20_ASYNC_H
+#define AHT20_ASYNC_H
+
+#include <Arduino.h>
+#include "I2cBus.h"
+#include "FixedPoint.h"
+
+// Неблокирующий драйвер AHT20: запуск измерения и чтение результата
+// разнесены по разным тикам, температура и влажность берутся из одного замера.
+class AHT20Async
+{
+public:
+    enum State : uint8_t
+    {
+        STATE_IDLE,       // измерение не запущено
+        STATE_MEASURING,  // ждем окончания преобразования
+        STATE_READY,      // свежие данные получены
+        STATE_ERROR       // ошибка шины, CRC или таймаут
+    };
+
+    static const uint8_t MEASUREMENT_TIME_MS = 80;
+    static const uint8_t MEASUREMENT_TIMEOUT_MS = 200;
+
+private:
+    static const uint8_t CMD_INIT = 0xBE;
+    static const uint8_t CMD_TRIGGER = 0xAC;
+    static const uint8_t STATUS_BUSY = 0x80;
+    static const uint8_t STATUS_CALIBRATED = 0x08;
+    static const uint8_t FRAME_SIZE = 7;
+
+    State state;
+    uint32_t triggerTime;
+
+    uint32_t rawHumidity;
+    uint32_t rawTemperature;
+
+    bool writeCommand(uint8_t cmd, uint8_t arg1, uint8_t arg2);
+    int16_t readStatus();
+    static uint8_t crc8(const uint8_t* data, uint8_t len);
+
+public:
+    AHT20Async();
+
+    // Проверка присутствия и калибровки (только при старте)
+    bool begin();
+
+    // Отправить команду измерения и сразу вернуться
+    bool trigger();
+
+    // Забрать результат, если преобразование закончилось
+    State poll();
+
+    State getState() const { return state; }
+    bool isBusy() const { return state == STATE_MEASURING; }
+
+    DeciCelsius getTemperature() const;
+    DeciPercent getHumidity() const;
+};
+
+#endif
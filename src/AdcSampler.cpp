@@ -0,0 +1,102 @@
+#include "AdcSampler.h"
+
+uint8_t AdcSampler::channels[MAX_CHANNELS] = {};
+uint8_t AdcSampler::channelCount = 0;
+volatile uint8_t AdcSampler::current = 0;
+AdcSampler::Accumulator AdcSampler::acc[MAX_CHANNELS] = {};
+volatile uint16_t AdcSampler::results[2][MAX_CHANNELS] = {};
+volatile uint8_t AdcSampler::front = 0;
+volatile uint8_t AdcSampler::completedRounds = 0;
+
+ISR(ADC_vect)
+{
+    AdcSampler::handleInterrupt();
+}
+
+AdcSampler::AdcSampler()
+{
+}
+
+int8_t AdcSampler::addChannel(uint8_t pin)
+{
+    if (channelCount >= MAX_CHANNELS)
+        return -1;
+
+    // Как в analogRead(): A0..A5 или сразу номер канала
+    if (pin >= A0)
+        pin -= A0;
+    channels[channelCount] = pin;
+    return static_cast<int8_t>(channelCount++);
+}
+
+void AdcSampler::begin()
+{
+    if (channelCount == 0)
+        return;
+
+    noInterrupts();
+    for (uint8_t i = 0; i < channelCount; i++)
+    {
+        acc[i].count = 0;
+        // Цифровой буфер на аналоговом входе не нужен, только шумит
+        if (channels[i] < 6)
+            DIDR0 |= _BV(channels[i]);
+    }
+    current = 0;
+    completedRounds = 0;
+    selectChannel(0);
+    // Запуск по TOV0: флаг сбрасывает обработчик millis(), так что фронт есть каждые 1024 мкс.
+    // Делитель 128: 125 кГц, преобразование ~104 мкс
+    ADCSRB = _BV(ADTS2);
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+    interrupts();
+}
+
+void AdcSampler::selectChannel(uint8_t index)
+{
+    // Опора AVcc. Новый канал подхватится на следующем запуске, времени на установление хватает
+    ADMUX = _BV(REFS0) | (channels[index] & 0x07);
+}
+
+void AdcSampler::handleInterrupt()
+{
+    uint16_t value = ADC;
+    uint8_t index = current;
+    Accumulator& a = acc[index];
+
+    if (a.count == 0)
+    {
+        a.sum = value;
+        a.min = value;
+        a.max = value;
+    }
+    else
+    {
+        a.sum += value;
+        if (value < a.min)
+            a.min = value;
+        if (value > a.max)
+            a.max = value;
+    }
+
+    if (++a.count >= SAMPLES_PER_RESULT)
+    {
+        // Усеченное среднее: 16 отсчетов без крайних, сумма / 4 = среднее * RESULT_SCALE
+        uint8_t back = front ^ 1;
+        results[back][index] = (a.sum - a.min - a.max) >> 2;
+        a.count = 0;
+
+        // Каналы перебираются по очереди, последний закрывает круг - меняем банки
+        if (index == channelCount - 1)
+        {
+            front = back;
+            if (completedRounds < 255)
+                completedRounds++;
+        }
+    }
+
+    if (++index >= channelCount)
+        index = 0;
+    current = index;
+    selectChannel(index);
+}
@@ -0,0 +1,57 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+
+// Фоновый опрос аналоговых входов. Преобразование запускается аппаратно по
+// переполнению Timer0 (~976 Гц), каналы перебираются по кругу в ISR(ADC_vect).
+// На канал копится блок из SAMPLES_PER_RESULT отсчетов, минимум и максимум
+// отбрасываются, сумма остальных 16 дает результат с 12 битами (x4 к analogRead).
+// Результаты лежат в двух банках: пока ISR заполняет один, читается другой.
+// После begin() analogRead() использовать нельзя. Поддерживается один экземпляр.
+class AdcSampler
+{
+public:
+    static const uint8_t MAX_CHANNELS = 4;
+    static const uint8_t SAMPLES_PER_RESULT = 18;
+    // Результат в единицах 1/RESULT_SCALE отсчета analogRead()
+    static const uint8_t RESULT_SCALE = 4;
+
+private:
+    struct Accumulator
+    {
+        uint16_t sum;
+        uint16_t min;
+        uint16_t max;
+        uint8_t count;
+    };
+
+    // Общие с обработчиком прерывания
+    static uint8_t channels[MAX_CHANNELS];   // номера мультиплексора
+    static uint8_t channelCount;
+    static volatile uint8_t current;
+    static Accumulator acc[MAX_CHANNELS];
+    static volatile uint16_t results[2][MAX_CHANNELS];
+    static volatile uint8_t front;           // банк для чтения
+    static volatile uint8_t completedRounds; // насыщается на 255
+
+    static void selectChannel(uint8_t index);
+
+public:
+    AdcSampler();
+
+    // Вызывать до begin(). Возвращает номер канала или -1
+    int8_t addChannel(uint8_t pin);
+    void begin();
+
+    // Хотя бы один полный блок по всем каналам уже готов
+    bool hasResult() const { return completedRounds > 0; }
+    // Фильтрованное значение, 0..1023 * RESULT_SCALE. Прерывания не запрещает:
+    // ISR пишет в другой банк, а банки меняются раз в несколько десятков мс
+    uint16_t getValue(uint8_t channel) const { return results[front][channel]; }
+
+    // Вызывается из ISR(ADC_vect)
+    static void handleInterrupt();
+};
+
+#endif
@@ -0,0 +1,226 @@
+#include "DailyLight.h"
+#include "RtcNvram.h"
+
+static const uint32_t SECONDS_PER_DAY = 86400UL;
+
+DailyLight::DailyLight(const Config& config) : config(config)
+{
+    // 1 ммоль/м² = 1000 мкмоль/м² = luxPerPpfd * 1000 лк*с
+    luxMsPerMmol = static_cast<uint32_t>(config.luxPerPpfd) * 1000000UL;
+    todayMmol = 0;
+    yesterdayMmol = 0;
+    remainder = 0;
+    nextBoundary = 0;
+    lastSample = 0;
+    lastSave = 0;
+    lastSwitch = 0;
+    started = false;
+    duty = 0;
+    for (uint8_t i = 0; i < 24; i++)
+    {
+        sunProfile[i] = 0;
+    }
+    sunHour = 24;
+    sunMmol = 0;
+    sunRemainder = 0;
+}
+
+void DailyLight::begin(uint32_t epoch)
+{
+    startDay(epoch);
+    load(epoch);
+    lastSave = millis();
+    lastSwitch = lastSave - MIN_SWITCH_MS;
+}
+
+void DailyLight::startDay(uint32_t epoch)
+{
+    uint32_t dayStart = static_cast<uint32_t>(config.dayStartHour) * 3600UL;
+    uint32_t sinceBoundary = (epoch + SECONDS_PER_DAY - dayStart) % SECONDS_PER_DAY;
+    nextBoundary = epoch - sinceBoundary + SECONDS_PER_DAY;
+    todayMmol = 0;
+    remainder = 0;
+}
+
+uint8_t DailyLight::update(Lux lux, bool luxValid, uint8_t lampDuty, uint32_t epoch)
+{
+    uint32_t now = millis();
+    uint32_t dtMs = started ? now - lastSample : 0;
+    lastSample = now;
+    started = true;
+
+    // Граница суток; часы, переведенные назад больше чем на сутки, - тоже новые сутки
+    if (epoch >= nextBoundary || epoch + SECONDS_PER_DAY < nextBoundary)
+    {
+        bool rolled = epoch >= nextBoundary && epoch < nextBoundary + SECONDS_PER_DAY;
+        yesterdayMmol = rolled ? todayMmol : 0;
+        if (rolled)
+        {
+            LOG_INFO(MAIN, EV_DLI_DAY, "DLI, 0.1 mol/m2", yesterdayMmol / 100);
+        }
+        startDay(epoch);
+        save();
+    }
+
+    if (!luxValid)
+        return duty;
+
+    // Лампа тоже светит на датчик: естественный свет - без ее вклада
+    uint32_t lampLux = static_cast<uint32_t>(lampDuty) * config.lampFullLux / 255U;
+    uint32_t natural = lux.getRaw() > lampLux ? lux.getRaw() - lampLux : 0;
+    addSun(natural, dtMs <= MAX_SAMPLE_MS ? dtMs : 0, epoch);
+
+    if (dtMs <= MAX_SAMPLE_MS)
+    {
+        // Вычитание вместо деления: за замер набегает не больше нескольких ммоль
+        remainder += lux.getRaw() * dtMs;
+        while (remainder >= luxMsPerMmol)
+        {
+            remainder -= luxMsPerMmol;
+            if (todayMmol < UINT16_MAX)
+                todayMmol++;
+        }
+    }
+    if (now - lastSave >= SAVE_PERIOD_MS)
+    {
+        lastSave = now;
+        save();
+    }
+
+    uint8_t next = plan(natural, epoch);
+    if ((next > 0) != (duty > 0))
+    {
+        if (now - lastSwitch < MIN_SWITCH_MS)
+        {
+            next = duty > 0 ? config.minDuty : 0;
+        }
+        else
+        {
+            lastSwitch = now;
+        }
+    }
+    duty = next;
+    return duty;
+}
+
+void DailyLight::addSun(uint32_t natural, uint32_t dtMs, uint32_t epoch)
+{
+    uint8_t hour = static_cast<uint8_t>(epoch % SECONDS_PER_DAY / 3600UL);
+    if (hour != sunHour)
+    {
+        // Час прошел: его ячейка теперь сегодняшняя. Неполный час (старт, пропуски) занижает ее
+        if (sunHour < 24)
+        {
+            uint16_t units = sunMmol / SUN_UNIT_MMOL;
+            sunProfile[sunHour] = units < 255 ? static_cast<uint8_t>(units) : 255;
+        }
+        sunHour = hour;
+        sunMmol = 0;
+        sunRemainder = 0;
+    }
+    // Как и суточный счетчик - вычитанием
+    sunRemainder += natural * dtMs;
+    while (sunRemainder >= luxMsPerMmol)
+    {
+        sunRemainder -= luxMsPerMmol;
+        if (sunMmol < UINT16_MAX)
+            sunMmol++;
+    }
+}
+
+uint32_t DailyLight::expectedSun(uint32_t secondOfDay) const
+{
+    // Вчерашнее солнце в полных часах до конца фотопериода, текущий час не в счет
+    uint16_t units = 0;
+    for (uint8_t h = (secondOfDay / 3600UL + 1) % 24; h != config.photoperiodTo; h = (h + 1) % 24)
+    {
+        units += sunProfile[h];
+    }
+    return static_cast<uint32_t>(units / 2) * SUN_UNIT_MMOL;
+}
+
+uint8_t DailyLight::plan(uint32_t natural, uint32_t epoch) const
+{
+    uint32_t secondOfDay = epoch % SECONDS_PER_DAY;
+    uint32_t from = static_cast<uint32_t>(config.photoperiodFrom) * 3600UL;
+    uint32_t to = static_cast<uint32_t>(config.photoperiodTo) * 3600UL;
+    uint32_t remaining;
+    if (from <= to)
+    {
+        if (secondOfDay < from || secondOfDay >= to)
+            return 0;
+        remaining = to - secondOfDay;
+    }
+    else
+    {
+        if (secondOfDay < from && secondOfDay >= to)
+            return 0;
+        remaining = secondOfDay >= from ? SECONDS_PER_DAY - secondOfDay + to : to - secondOfDay;
+    }
+    if (todayMmol >= config.targetMmol || config.lampFullLux == 0)
+        return 0;
+
+    // На лампу остается недобор без половины ожидаемого солнца
+    uint32_t deficit = config.targetMmol - todayMmol;
+    uint32_t sun = expectedSun(secondOfDay);
+    if (deficit <= sun)
+        return 0;
+    uint32_t lampLuxS = (deficit - sun) * config.luxPerPpfd * 1000UL;
+
+    // Позднее включение: пока лампа на полной мощности успевает с запасом, ждем солнца
+    if (lampLuxS / config.lampFullLux + START_MARGIN_S < remaining)
+        return 0;
+
+    // Средний свет, который до конца фотопериода добрал бы остаток
+    uint32_t needLux = lampLuxS / remaining;
+    if (needLux <= natural)
+        return 0;
+
+    uint32_t extra = needLux - natural;
+    if (extra >= config.lampFullLux)
+        return 255;
+    uint8_t result = static_cast<uint8_t>(extra * 255U / config.lampFullLux);
+    return result >= config.minDuty ? result : 0;
+}
+
+void DailyLight::load(uint32_t epoch)
+{
+    uint8_t data[NVRAM_SIZE];
+    if (!RtcNvram::read(RtcNvram::DLI_OFFSET, data, sizeof(data)))
+        return;
+
+    uint8_t check = 0;
+    for (uint8_t i = 0; i < NVRAM_SIZE - 1; i++)
+    {
+        check ^= data[i];
+    }
+    if (data[0] != NVRAM_MAGIC || check != data[NVRAM_SIZE - 1])
+        return;
+
+    // Счетчик годится, только если сохранен в эти же сутки
+    uint32_t boundary = static_cast<uint32_t>(data[1]) | (static_cast<uint32_t>(data[2]) << 8) |
+                        (static_cast<uint32_t>(data[3]) << 16) | (static_cast<uint32_t>(data[4]) << 24);
+    if (boundary == nextBoundary && epoch < boundary)
+    {
+        todayMmol = static_cast<uint16_t>(data[5] | (data[6] << 8));
+    }
+}
+
+void DailyLight::save() const
+{
+    uint8_t data[NVRAM_SIZE];
+    data[0] = NVRAM_MAGIC;
+    data[1] = static_cast<uint8_t>(nextBoundary);
+    data[2] = static_cast<uint8_t>(nextBoundary >> 8);
+    data[3] = static_cast<uint8_t>(nextBoundary >> 16);
+    data[4] = static_cast<uint8_t>(nextBoundary >> 24);
+    data[5] = static_cast<uint8_t>(todayMmol);
+    data[6] = static_cast<uint8_t>(todayMmol >> 8);
+    uint8_t check = 0;
+    for (uint8_t i = 0; i < NVRAM_SIZE - 1; i++)
+    {
+        check ^= data[i];
+    }
+    data[NVRAM_SIZE - 1] = check;
+    RtcNvram::write(RtcNvram::DLI_OFFSET, data, sizeof(data));
+}
@@ -0,0 +1,86 @@
+#ifndef DAILY_LIGHT_H
+#define DAILY_LIGHT_H
+
+#include <Arduino.h>
+#include "FixedPoint.h"
+#include "Log.h"
+
+// Дневной интеграл освещенности (DLI) и досветка по его недобору.
+// Каждый замер освещенности прибавляется к счетчику за сутки в ммоль/м²
+// (ФАР по люксам, luxPerPpfd лк на мкмоль/м²/с); только сложения и вычитания,
+// без деления. Сутки начинаются в dayStartHour, счетчик раз в SAVE_PERIOD_MS
+// сохраняется в NVRAM часов и переживает сброс.
+// Естественный свет (без вклада лампы) копится и по часам суток: пока час
+// не прошел, в его ячейке лежит вчерашнее значение. Из недобора вычитается
+// половина ожидаемого по вчерашним ячейкам солнца на оставшиеся часы
+// фотопериода, остаток - работа лампы. Лампа включается как можно позже: когда
+// до конца фотопериода остается лишь время, за которое она на полной мощности
+// добрала бы этот остаток, плюс START_MARGIN_S. Дальше она светит на нужный
+// средний уровень (остаток / оставшееся время) минус нынешний естественный.
+// Утром лампа ждет солнца, в солнечный день не нужна, в пасмурный светит
+// дольше и ярче. После сброса ячейки пусты - лампа не рассчитывает на солнце.
+class DailyLight
+{
+public:
+    static const uint32_t SAVE_PERIOD_MS = 600000UL;
+    static const uint16_t MAX_SAMPLE_MS = 5000;  // дольше без замера - пропуск, а не экстраполяция
+    static const uint32_t MIN_SWITCH_MS = 600000UL;  // облака не должны щелкать лампой
+    static const uint16_t START_MARGIN_S = 3600;     // запас к позднему включению
+    static const uint8_t SUN_UNIT_MMOL = 32;         // единица ячейки часа, до 8 моль/м² в час
+
+    struct Config
+    {
+        uint16_t targetMmol;     // DLI за сутки, ммоль/м² (мол/м² * 1000)
+        uint8_t dayStartHour;    // граница суток счетчика
+        uint8_t photoperiodFrom; // часы досветки [from, to)
+        uint8_t photoperiodTo;
+        uint16_t luxPerPpfd;     // 54 для солнечного света
+        uint16_t lampFullLux;    // прибавка к показаниям датчика от лампы на полной мощности
+        uint8_t minDuty;         // слабее лампа не включается
+    };
+
+private:
+    static const uint8_t NVRAM_MAGIC = 0xD1;
+    static const uint8_t NVRAM_SIZE = 8;
+
+    Config config;
+    uint32_t luxMsPerMmol;
+
+    uint16_t todayMmol;
+    uint16_t yesterdayMmol;
+    uint32_t remainder;     // лк * мс, меньше luxMsPerMmol
+    uint32_t nextBoundary;  // начало следующих суток, epoch
+    uint32_t lastSample;
+    uint32_t lastSave;
+    uint32_t lastSwitch;
+    bool started;
+    uint8_t duty;
+
+    uint8_t sunProfile[24];  // естественный свет по часам, SUN_UNIT_MMOL
+    uint8_t sunHour;         // час, который сейчас копится; 24 - еще никакой
+    uint16_t sunMmol;        // за этот час
+    uint32_t sunRemainder;   // лк * мс, меньше luxMsPerMmol
+
+    void startDay(uint32_t epoch);
+    void addSun(uint32_t natural, uint32_t dtMs, uint32_t epoch);
+    uint32_t expectedSun(uint32_t secondOfDay) const;
+    uint8_t plan(uint32_t natural, uint32_t epoch) const;
+    void load(uint32_t epoch);
+    void save() const;
+
+public:
+    explicit DailyLight(const Config& config);
+
+    // Восстановить счетчик текущих суток из NVRAM часов
+    void begin(uint32_t epoch);
+
+    // Замер освещенности (с периодом обновления датчиков), lampDuty - как сейчас горит лампа.
+    // Возвращает скважность лампы 0..255; без датчика - прежнюю
+    uint8_t update(Lux lux, bool luxValid, uint8_t lampDuty, uint32_t epoch);
+
+    uint16_t getTodayMmol() const { return todayMmol; }
+    uint16_t getYesterdayMmol() const { return yesterdayMmol; }
+    uint8_t getDuty() const { return duty; }
+};
+
+#endif
@@ -5,12 +5,20 @@ DeviceManager::DeviceManager(uint8_t lightPin, uint8_t fanPin, uint8_t pumpPin)
     lightState = false;
     fanState = false;
     pumpState = false;
+    lightDuty = 0;
+
+    fanTarget = 0;
+    fanDuty = 0;
+    fanStartTime = 0;
+    fanSlewTime = 0;
 
     pumpFlowRate = 100; // 100 мл/мин
     pumpAutoStop = false;
     pumpStartTime = 0;
     pumpDuration = 0;
+    pumpRunMs = 0;
 
+    listener = nullptr;
 }
 
 void DeviceManager::init() const
@@ -26,14 +34,33 @@ void DeviceManager::init() const
 
 void DeviceManager::setLight(bool state)
 {
+    setLightLevel(state ? 255 : 0);
+}
+
+void DeviceManager::setLightLevel(uint8_t duty)
+{
+    if (duty == lightDuty)
+        return;
+    bool state = duty > 0;
+    notify(DEVICE_LIGHT, lightState, state);
     lightState = state;
-    digitalWrite(lightPin, state ? HIGH : LOW);
+    lightDuty = duty;
+    analogWrite(lightPin, duty);
 }
 
 void DeviceManager::setFan(bool state)
 {
-    fanState = state;
-    digitalWrite(fanPin, state ? HIGH : LOW);
+    setFanSpeed(state ? 255 : 0);
+}
+
+void DeviceManager::setFanSpeed(uint8_t speed)
+{
+    uint8_t target = 0;
+    if (speed > 0)
+    {
+        target = FAN_MIN_DUTY + static_cast<uint8_t>((static_cast<uint16_t>(255 - FAN_MIN_DUTY) * speed) / 255U);
+    }
+    fanTarget = target;
 }
 
 void DeviceManager::startPump(uint16_t ml)
@@ -42,15 +69,25 @@ void DeviceManager::startPump(uint16_t ml)
     {
         return;
     }
+    if (pumpState)
+    {
+        pumpRunMs += millis() - pumpStartTime;
+    }
     pumpDuration = calculatePumpTime(ml);
     pumpStartTime = millis();
     pumpAutoStop = true;
+    notify(DEVICE_PUMP, pumpState, true);
     pumpState = true;
     digitalWrite(pumpPin, HIGH);
 }
 
 void DeviceManager::stopPump()
 {
+    if (pumpState)
+    {
+        pumpRunMs += millis() - pumpStartTime;
+    }
+    notify(DEVICE_PUMP, pumpState, false);
     pumpState = false;
     digitalWrite(pumpPin, LOW);
     pumpAutoStop = false;
@@ -59,6 +96,7 @@ void DeviceManager::stopPump()
 void DeviceManager::update()
 {
     updatePump();
+    updateFan();
 }
 
 void DeviceManager::updatePump()
@@ -80,6 +118,64 @@ void DeviceManager::updatePump()
     }
 }
 
+void DeviceManager::updateFan()
+{
+    uint32_t now = millis();
+    uint8_t target = fanTarget;
+    if (target == 0 && fanDuty > 0 && now - fanStartTime < FAN_MIN_RUN_MS)
+    {
+        target = FAN_MIN_DUTY;
+    }
+    if (fanDuty == target)
+    {
+        // Шаг к новой цели отсчитывается от последнего обновления в покое
+        fanSlewTime = now;
+        return;
+    }
+
+    uint32_t step = (now - fanSlewTime) * FAN_SLEW_PER_S / 1000UL;
+    if (step == 0)
+        return;
+    fanSlewTime = now;
+
+    uint16_t duty;
+    if (target > fanDuty)
+    {
+        // Старт сразу с минимальной скважности
+        duty = fanDuty + step < target ? fanDuty + step : target;
+        if (duty < FAN_MIN_DUTY)
+            duty = FAN_MIN_DUTY;
+    }
+    else
+    {
+        duty = static_cast<uint16_t>(fanDuty - target) > step ? fanDuty - step : target;
+        if (duty < FAN_MIN_DUTY)
+            duty = target;
+    }
+    writeFan(static_cast<uint8_t>(duty));
+}
+
+void DeviceManager::writeFan(uint8_t duty)
+{
+    bool state = duty > 0;
+    if (state && fanDuty == 0)
+    {
+        fanStartTime = millis();
+    }
+    notify(DEVICE_FAN, fanState, state);
+    fanState = state;
+    fanDuty = duty;
+    analogWrite(fanPin, duty);
+}
+
+void DeviceManager::notify(Device device, bool previous, bool state) const
+{
+    if (listener != nullptr && previous != state)
+    {
+        listener(device, state);
+    }
+}
+
 uint32_t DeviceManager::calculatePumpTime(uint16_t ml) const
 {
     return (static_cast<uint32_t>(ml) * 60000UL) / pumpFlowRate;
@@ -5,6 +5,17 @@
 #include <Wire.h>
 class DeviceManager
 {
+public:
+    enum Device : uint8_t
+    {
+        DEVICE_LIGHT,
+        DEVICE_FAN,
+        DEVICE_PUMP
+    };
+
+    // Вызывается при каждом включении/выключении устройства
+    typedef void (*StateListener)(Device device, bool state);
+
 private:
     // Пины устройств
     uint8_t lightPin;
@@ -15,18 +26,37 @@ private:
     bool lightState;
     bool fanState;
     bool pumpState;
+    uint8_t lightDuty;
+
+    // Вентилятор на ШИМ: скважность плавно идет к цели
+    uint8_t fanTarget;
+    uint8_t fanDuty;
+    uint32_t fanStartTime;
+    uint32_t fanSlewTime;
 
     // Управление насосом
     uint32_t pumpStartTime;
     uint32_t pumpDuration;
     bool pumpAutoStop;
     uint16_t pumpFlowRate; // мл в минуту
+    uint32_t pumpRunMs;    // всего проработал, без текущего включения
+
+    StateListener listener;
 
     // Приватные методы
     void updatePump();
+    void updateFan();
+    void writeFan(uint8_t duty);
+    void notify(Device device, bool previous, bool state) const;
     uint32_t calculatePumpTime(uint16_t ml) const;
 
 public:
+    // Ниже FAN_MIN_DUTY вентилятор не стартует; быстрее FAN_SLEW_PER_S скважность не меняется;
+    // включившись, он работает не меньше FAN_MIN_RUN_MS
+    static const uint8_t FAN_MIN_DUTY = 77;      // 30 %
+    static const uint8_t FAN_SLEW_PER_S = 51;    // 20 % в секунду
+    static const uint32_t FAN_MIN_RUN_MS = 300000UL;
+
     // Конструктор с настройкой пинов
     DeviceManager(uint8_t lightPin, uint8_t fanPin, uint8_t pumpPin);
 
@@ -35,20 +65,31 @@ public:
 
     // Управление устройствами
     void setLight(bool state);
+    // Диммирование лампы ШИМ: 0 - выключить, 255 - полная яркость
+    void setLightLevel(uint8_t duty);
     void setFan(bool state);
+    // 0 - выключить, 1..255 - от минимальной до полной скорости
+    void setFanSpeed(uint8_t speed);
     void startPump(uint16_t ml); // Полив заданного объема в мл
     void stopPump();
 
     // Статус
     bool isLightOn() const { return lightState; }
+    uint8_t getLightDuty() const { return lightDuty; }
     bool isFanOn() const { return fanState; }
+    uint8_t getFanDuty() const { return fanDuty; }
     bool isPumpOn() const { return pumpState; }
 
-    // Обновление состояния (вызывать в loop для управления насосом)
+    // Обновление состояния (вызывать в loop для управления насосом и вентилятором)
     void update();
 
-    // Настройка производительности насоса (мл/мин)
-    void setPumpFlowRate(uint16_t mlPerMin) { pumpFlowRate = mlPerMin; }
+    // Настройка производительности насоса (мл/мин), действует со следующего включения
+    void setPumpFlowRate(uint16_t mlPerMin) { pumpFlowRate = mlPerMin > 0 ? mlPerMin : 1; }
+    uint16_t getPumpFlowRate() const { return pumpFlowRate; }
+    // Суммарное время работы насоса по завершенным включениям
+    uint32_t getPumpRunMs() const { return pumpRunMs; }
+
+    void setStateListener(StateListener callback) { listener = callback; }
 };
 
 #endif
\ No newline at end of file
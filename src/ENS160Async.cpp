@@ -0,0 +1,39 @@
+#include "ENS160Async.h"
+
+ENS160Async::ENS160Async()
+{
+    eco2 = 0;
+    tvoc = 0;
+    aqi = 0;
+    validity = 0;
+    sampleTime = 0;
+    hasSample = false;
+}
+
+bool ENS160Async::poll()
+{
+    uint8_t status;
+    if (!I2cBus::readRegisters(I2cBus::DEV_ENS160, REG_DATA_STATUS, &status, 1, true))
+    {
+        return false;
+    }
+
+    if (!(status & STATUS_NEWDAT) || (status & STATUS_STATER))
+    {
+        return false;
+    }
+
+    uint8_t data[DATA_SIZE];
+    if (!I2cBus::readRegisters(I2cBus::DEV_ENS160, REG_DATA_AQI, data, DATA_SIZE, true))
+    {
+        return false;
+    }
+
+    aqi = data[0] & 0x07;
+    tvoc = data[1] | (static_cast<uint16_t>(data[2]) << 8);
+    eco2 = data[3] | (static_cast<uint16_t>(data[4]) << 8);
+    validity = (status & STATUS_VALIDITY) >> 2;
+    sampleTime = millis();
+    hasSample = true;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef ENS160_ASYNC_H
+#define ENS160_ASYNC_H
+
+#include <Arduino.h>
+#include "I2cBus.h"
+
+// Чтение данных ENS160 по флагу готовности: на большинстве тиков
+// читается только байт статуса, eCO2/TVOC/AQI забираются одной пачкой
+// только когда датчик выставил NEWDAT.
+// Инициализация и выбор режима остаются за ScioSense_ENS160.
+class ENS160Async
+{
+private:
+    static const uint8_t REG_DATA_STATUS = 0x20;
+    static const uint8_t REG_DATA_AQI = 0x21;
+    static const uint8_t DATA_SIZE = 5;         // AQI, TVOC(2), eCO2(2)
+    static const uint8_t STATUS_NEWDAT = 0x02;
+    static const uint8_t STATUS_VALIDITY = 0x0C;
+    static const uint8_t STATUS_STATER = 0x40;
+
+    uint16_t eco2;
+    uint16_t tvoc;
+    uint8_t aqi;
+    uint8_t validity;        // 0 - норма, 1 - прогрев, 2 - первичный запуск, 3 - неверно
+    uint32_t sampleTime;     // millis() последнего нового замера
+    bool hasSample;
+
+public:
+    ENS160Async();
+
+    // Опрос статуса; при наличии новых данных читает их. true - получен новый замер
+    bool poll();
+
+    bool hasData() const { return hasSample; }
+    uint16_t getECO2() const { return eco2; }
+    uint16_t getTVOC() const { return tvoc; }
+    uint8_t getAQI() const { return aqi; }
+    uint8_t getValidity() const { return validity; }
+    uint32_t getSampleTime() const { return sampleTime; }
+};
+
+#endif
@@ -0,0 +1,257 @@
+#include "EepromLog.h"
+#include <TimeLib.h>
+
+EepromLog::EepromLog()
+{
+    queueHead = 0;
+    queueCount = 0;
+    writeIndex = 0;
+    nextSlot = 0;
+    nextSequence = 0;
+    storedRecords = 0;
+    droppedRecords = 0;
+}
+
+uint8_t* EepromLog::slotAddress(uint8_t slot)
+{
+    return reinterpret_cast<uint8_t*>(LOG_START + static_cast<uint16_t>(slot) * RECORD_SIZE);
+}
+
+uint8_t EepromLog::crc8(const uint8_t* data, uint8_t len)
+{
+    // Тот же CRC-8, что у AHT20: полином 0x31, начальное 0xFF
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+bool EepromLog::readSlot(uint8_t slot, uint8_t* record) const
+{
+    eeprom_read_block(record, slotAddress(slot), RECORD_SIZE);
+    uint8_t type = record[2];
+    if (type != RECORD_SNAPSHOT && type != RECORD_DEVICE)
+        return false;
+    return crc8(record, RECORD_SIZE - 1) == record[RECORD_SIZE - 1];
+}
+
+uint8_t EepromLog::begin()
+{
+    // Записи идут по кругу с номерами подряд: конец журнала - первый слот,
+    // за которым нет записи с номером на единицу больше
+    uint8_t record[RECORD_SIZE];
+    uint8_t valid = 0;
+    bool found = false;
+    uint8_t lastSlot = 0;
+    uint16_t lastSequence = 0;
+
+    for (uint8_t slot = 0; slot < LOG_SLOTS; slot++)
+    {
+        if (!readSlot(slot, record))
+            continue;
+        valid++;
+
+        uint16_t sequence = record[0] | (record[1] << 8);
+        uint8_t next = (slot + 1) % LOG_SLOTS;
+        uint8_t following[RECORD_SIZE];
+        bool continues = readSlot(next, following) &&
+                         static_cast<uint16_t>(following[0] | (following[1] << 8)) == static_cast<uint16_t>(sequence + 1);
+        if (!continues && !found)
+        {
+            found = true;
+            lastSlot = slot;
+            lastSequence = sequence;
+        }
+    }
+
+    if (found)
+    {
+        nextSlot = (lastSlot + 1) % LOG_SLOTS;
+        nextSequence = lastSequence + 1;
+    }
+    else
+    {
+        nextSlot = 0;
+        nextSequence = 0;
+    }
+    storedRecords = valid;
+    return valid;
+}
+
+bool EepromLog::enqueue(uint8_t type, const uint8_t* payload)
+{
+    if (queueCount >= QUEUE_SIZE)
+    {
+        if (droppedRecords < UINT16_MAX)
+            droppedRecords++;
+        return false;
+    }
+
+    uint8_t* record = queue[(queueHead + queueCount) % QUEUE_SIZE];
+    record[0] = static_cast<uint8_t>(nextSequence);
+    record[1] = static_cast<uint8_t>(nextSequence >> 8);
+    record[2] = type;
+    memcpy(record + PAYLOAD_OFFSET, payload, PAYLOAD_SIZE);
+    record[RECORD_SIZE - 1] = crc8(record, RECORD_SIZE - 1);
+
+    nextSequence++;
+    queueCount++;
+    return true;
+}
+
+bool EepromLog::logSnapshot(const Snapshot& snapshot)
+{
+    // 12 байт: минуты с 2020 (3), T 0.1 °C (2), RH 0.5 % (1), CO2 8 ppm (1),
+    // свет 2 лк (2), почва % (1+1), вода л (1)
+    uint8_t payload[PAYLOAD_SIZE];
+    uint32_t minutes = snapshot.time > EPOCH_2020 ? (snapshot.time - EPOCH_2020) / 60UL : 0;
+    uint16_t humidity = (snapshot.humidity.getRaw() + 2) / 5;
+    uint16_t co2 = (snapshot.co2.getRaw() + 4) / 8;
+    uint32_t light = (snapshot.light.getRaw() + 1) / 2;
+    uint32_t water = (snapshot.water.getRaw() + 500UL) / 1000UL;
+    int16_t temperature = snapshot.temperature.getRaw();
+
+    payload[0] = static_cast<uint8_t>(minutes);
+    payload[1] = static_cast<uint8_t>(minutes >> 8);
+    payload[2] = static_cast<uint8_t>(minutes >> 16);
+    payload[3] = static_cast<uint8_t>(temperature);
+    payload[4] = static_cast<uint8_t>(temperature >> 8);
+    payload[5] = humidity > 255 ? 255 : humidity;
+    payload[6] = co2 > 255 ? 255 : co2;
+    light = light > UINT16_MAX ? UINT16_MAX : light;
+    payload[7] = static_cast<uint8_t>(light);
+    payload[8] = static_cast<uint8_t>(light >> 8);
+    payload[9] = snapshot.soil1;
+    payload[10] = snapshot.soil2;
+    payload[11] = water > 255 ? 255 : water;
+
+    return enqueue(RECORD_SNAPSHOT, payload);
+}
+
+bool EepromLog::logDevice(uint32_t time, DeviceManager::Device device, bool on)
+{
+    uint8_t payload[PAYLOAD_SIZE] = {0};
+    payload[0] = static_cast<uint8_t>(time);
+    payload[1] = static_cast<uint8_t>(time >> 8);
+    payload[2] = static_cast<uint8_t>(time >> 16);
+    payload[3] = static_cast<uint8_t>(time >> 24);
+    payload[4] = device;
+    payload[5] = on ? 1 : 0;
+
+    return enqueue(RECORD_DEVICE, payload);
+}
+
+void EepromLog::update()
+{
+    // eeprom_update_byte не пишет совпадающие байты, такие проходим сразу
+    while (queueCount > 0 && eeprom_is_ready())
+    {
+        const uint8_t* record = queue[queueHead];
+        eeprom_update_byte(slotAddress(nextSlot) + writeIndex, record[writeIndex]);
+
+        if (++writeIndex < RECORD_SIZE)
+            continue;
+
+        writeIndex = 0;
+        nextSlot = (nextSlot + 1) % LOG_SLOTS;
+        if (storedRecords < LOG_SLOTS)
+            storedRecords++;
+        queueHead = (queueHead + 1) % QUEUE_SIZE;
+        queueCount--;
+    }
+}
+
+void EepromLog::dump(Print& out) const
+{
+    out.print(F("eeprom log: "));
+    out.print(storedRecords);
+    out.print(F(" records, dropped "));
+    out.println(droppedRecords);
+
+    // Слоты после конца журнала - самые старые записи
+    uint8_t record[RECORD_SIZE];
+    for (uint8_t i = 0; i < LOG_SLOTS; i++)
+    {
+        uint8_t slot = (nextSlot + i) % LOG_SLOTS;
+        if (readSlot(slot, record))
+        {
+            printRecord(out, record);
+        }
+    }
+}
+
+void EepromLog::printTime(Print& out, uint32_t time, bool seconds)
+{
+    tmElements_t tm;
+    breakTime(time, tm);
+
+    out.print(tmYearToCalendar(tm.Year));
+    out.write('-');
+    if (tm.Month < 10) out.write('0');
+    out.print(tm.Month);
+    out.write('-');
+    if (tm.Day < 10) out.write('0');
+    out.print(tm.Day);
+    out.write(' ');
+    if (tm.Hour < 10) out.write('0');
+    out.print(tm.Hour);
+    out.write(':');
+    if (tm.Minute < 10) out.write('0');
+    out.print(tm.Minute);
+    if (seconds)
+    {
+        out.write(':');
+        if (tm.Second < 10) out.write('0');
+        out.print(tm.Second);
+    }
+}
+
+void EepromLog::printRecord(Print& out, const uint8_t* record)
+{
+    const uint8_t* p = record + PAYLOAD_OFFSET;
+
+    out.write('#');
+    out.print(static_cast<uint16_t>(record[0] | (record[1] << 8)));
+    out.write(' ');
+
+    if (record[2] == RECORD_SNAPSHOT)
+    {
+        uint32_t minutes = p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+        printTime(out, EPOCH_2020 + minutes * 60UL, false);
+        out.print(F(" T="));
+        printFixed(out, DeciCelsius::fromRaw(static_cast<int16_t>(p[3] | (p[4] << 8))));
+        out.print(F(" H="));
+        printFixed(out, DeciPercent::fromRaw(p[5] * 5U));
+        out.print(F(" CO2="));
+        out.print(p[6] * 8U);
+        out.print(F(" L="));
+        out.print((p[7] | (static_cast<uint32_t>(p[8]) << 8)) * 2UL);
+        out.print(F(" S="));
+        out.print(p[9]);
+        out.write('/');
+        out.print(p[10]);
+        out.print(F(" W="));
+        out.print(p[11]);
+        out.println('L');
+    }
+    else
+    {
+        uint32_t time = p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+                        (static_cast<uint32_t>(p[3]) << 24);
+        printTime(out, time, true);
+        switch (p[4])
+        {
+        case DeviceManager::DEVICE_LIGHT: out.print(F(" light")); break;
+        case DeviceManager::DEVICE_FAN: out.print(F(" fan")); break;
+        case DeviceManager::DEVICE_PUMP: out.print(F(" pump")); break;
+        default: out.print(F(" device ")); out.print(p[4]);
+        }
+        out.println(p[5] ? F(" on") : F(" off"));
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef EEPROM_LOG_H
+#define EEPROM_LOG_H
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include "FixedPoint.h"
+#include "DeviceManager.h"
+
+// Кольцевой журнал в EEPROM: записи по 16 байт с номером и CRC.
+// Запись идет по кругу, каждая ячейка перезаписывается раз в LOG_SLOTS записей.
+// Байты пишутся по одному, только когда EEPROM свободна (~3.3 мс на байт),
+// поэтому update() никогда не ждет. CRC пишется последним: запись, оборванная
+// сбросом, не проходит проверку и при старте считается пустым слотом.
+class EepromLog
+{
+public:
+    // Верхние 256 байт EEPROM оставлены под настройки
+    static const uint16_t LOG_START = 0;
+    static const uint8_t RECORD_SIZE = 16;
+    static const uint8_t LOG_SLOTS = 48;
+    static const uint8_t QUEUE_SIZE = 4;
+
+    enum RecordType : uint8_t
+    {
+        RECORD_SNAPSHOT = 0x01,
+        RECORD_DEVICE = 0x02
+    };
+
+    // Снимок показаний в исходных единицах; сжимается при записи
+    struct Snapshot
+    {
+        uint32_t time;  // unix-время
+        DeciCelsius temperature;
+        DeciPercent humidity;
+        Ppm co2;
+        Lux light;
+        uint8_t soil1;
+        uint8_t soil2;
+        Millilitres water;
+    };
+
+private:
+    static const uint8_t PAYLOAD_OFFSET = 3;  // seq (2), type (1)
+    static const uint8_t PAYLOAD_SIZE = RECORD_SIZE - PAYLOAD_OFFSET - 1;
+    static const uint32_t EPOCH_2020 = 1577836800UL;
+
+    uint8_t queue[QUEUE_SIZE][RECORD_SIZE];
+    uint8_t queueHead;
+    uint8_t queueCount;
+    uint8_t writeIndex;  // следующий байт текущей записи
+
+    uint8_t nextSlot;
+    uint16_t nextSequence;
+    uint8_t storedRecords;
+    uint16_t droppedRecords;
+
+    static uint8_t* slotAddress(uint8_t slot);
+    static uint8_t crc8(const uint8_t* data, uint8_t len);
+    bool readSlot(uint8_t slot, uint8_t* record) const;
+    bool enqueue(uint8_t type, const uint8_t* payload);
+    static void printRecord(Print& out, const uint8_t* record);
+    static void printTime(Print& out, uint32_t time, bool seconds);
+
+public:
+    EepromLog();
+
+    // Найти конец журнала после сброса. Возвращает число целых записей
+    uint8_t begin();
+
+    bool logSnapshot(const Snapshot& snapshot);
+    bool logDevice(uint32_t time, DeviceManager::Device device, bool on);
+
+    // Шаг записи: вызывать часто, пишет не больше байта за раз
+    void update();
+
+    // Все записи от старых к новым (блокирует, только по команде)
+    void dump(Print& out) const;
+
+    bool isIdle() const { return queueCount == 0; }
+    uint8_t getStoredRecords() const { return storedRecords; }
+    uint16_t getDroppedRecords() const { return droppedRecords; }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "FanController.h"
+
+FanController::FanController(const Config& config) : config(config)
+{
+    reset();
+}
+
+void FanController::reset()
+{
+    integral = 0;
+    lastError = 0;
+    output = 0;
+    lastUpdate = 0;
+    started = false;
+    running = false;
+}
+
+int16_t FanController::weightedError(int32_t value, int32_t setpoint, int32_t band, uint8_t weight)
+{
+    if (band <= 0 || weight == 0)
+        return -FULL_SCALE;
+
+    int32_t error = (value - setpoint) * FULL_SCALE / band;
+    error = constrain(error, -FULL_SCALE, FULL_SCALE);
+    return static_cast<int16_t>(error * weight / 100);
+}
+
+uint8_t FanController::update(DeciCelsius temperature, DeciPercent humidity, Ppm co2, bool co2Valid)
+{
+    int16_t error = weightedError(temperature.getRaw(), config.tempSetpoint.getRaw(), config.tempBand.getRaw(),
+                                  config.tempWeight);
+    int16_t humError =
+        weightedError(humidity.getRaw(), config.humSetpoint.getRaw(), config.humBand.getRaw(), config.humWeight);
+    int16_t co2Error = weightedError(co2.getRaw(), config.co2Setpoint.getRaw(), config.co2Band.getRaw(),
+                                     co2Valid ? config.co2Weight : 0);
+    if (humError > error)
+        error = humError;
+    if (co2Error > error)
+        error = co2Error;
+
+    uint32_t now = millis();
+    uint32_t dtMs = started ? now - lastUpdate : 0;
+    lastUpdate = now;
+
+    int32_t p = static_cast<int32_t>(error) * config.kp / 16;
+    int32_t d = 0;
+    if (started && dtMs > 0 && config.kd > 0)
+    {
+        d = static_cast<int32_t>(error - lastError) * config.kd * 1000 / (16 * static_cast<int32_t>(dtMs));
+    }
+
+    // Интегрируем, только если выход не упирается в предел в ту же сторону
+    int32_t unclamped = p + integral / 1000 + d;
+    bool saturatedHigh = unclamped >= FULL_SCALE && error > 0;
+    bool saturatedLow = unclamped <= 0 && error < 0;
+    if (dtMs > 0 && !saturatedHigh && !saturatedLow)
+    {
+        if (dtMs > MAX_DT_MS)
+            dtMs = MAX_DT_MS;
+        integral += static_cast<int32_t>(error) * config.ki * static_cast<int32_t>(dtMs) / 16;
+        integral = constrain(integral, 0L, static_cast<int32_t>(FULL_SCALE) * 1000L);
+    }
+
+    int32_t u = p + integral / 1000 + d;
+    output = static_cast<int16_t>(constrain(u, 0L, static_cast<int32_t>(FULL_SCALE)));
+    lastError = error;
+    started = true;
+
+    if (!running && output >= config.onLevel)
+    {
+        running = true;
+    }
+    else if (running && output <= config.offLevel)
+    {
+        running = false;
+    }
+
+    if (!running)
+        return 0;
+
+    // Работающему вентилятору нужна ненулевая скорость, минимум обеспечит DeviceManager
+    uint8_t speed = static_cast<uint8_t>(static_cast<int32_t>(output) * 255 / FULL_SCALE);
+    return speed > 0 ? speed : 1;
+}
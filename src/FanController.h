@@ -0,0 +1,66 @@
+#ifndef FAN_CONTROLLER_H
+#define FAN_CONTROLLER_H
+
+#include <Arduino.h>
+#include "FixedPoint.h"
+
+// ПИД-регулятор скорости вентилятора. Ошибка каждого канала нормируется
+// на его полосу (FULL_SCALE = отклонение на одну полосу) и умножается на вес;
+// регулируется по худшему каналу, чтобы прохлада не гасила избыток CO2.
+// Интегратор не копится в насыщении и ограничен диапазоном выхода.
+// Включение/выключение с гистерезисом по уровню выхода.
+class FanController
+{
+public:
+    static const int16_t FULL_SCALE = 1000;  // промилле
+    // Дольше между вызовами - пропуск, интегрируем не больше этого;
+    // так error * ki * dt не выходит за int32 при любом ki
+    static const uint32_t MAX_DT_MS = 2000;
+    static_assert(static_cast<int64_t>(FULL_SCALE) * 255 * MAX_DT_MS <= INT32_MAX, "integral step overflows int32");
+
+    struct Config
+    {
+        DeciCelsius tempSetpoint;
+        DeciCelsius tempBand;
+        DeciPercent humSetpoint;
+        DeciPercent humBand;
+        Ppm co2Setpoint;
+        Ppm co2Band;
+        uint8_t tempWeight;  // %, 0 - канал не участвует
+        uint8_t humWeight;
+        uint8_t co2Weight;
+        uint8_t kp;          // x16: 16 - полная скорость при ошибке в одну полосу
+        uint8_t ki;          // x16 в секунду
+        uint8_t kd;          // x16 * с, по изменению ошибки
+        int16_t onLevel;     // выход (промилле), выше которого вентилятор включается
+        int16_t offLevel;    // и ниже которого выключается
+    };
+
+private:
+    Config config;
+    int32_t integral;    // промилле * 1000
+    int16_t lastError;
+    int16_t output;
+    uint32_t lastUpdate;
+    bool started;
+    bool running;
+
+    static int16_t weightedError(int32_t value, int32_t setpoint, int32_t band, uint8_t weight);
+
+public:
+    explicit FanController(const Config& config);
+
+    void setConfig(const Config& newConfig) { config = newConfig; }
+    const Config& getConfig() const { return config; }
+    void reset();
+
+    // Шаг регулятора, вызывать с периодом обновления датчиков.
+    // Возвращает скорость 0..255 для DeviceManager::setFanSpeed (0 - выключить).
+    // co2Valid = false - канал CO2 не участвует, как при нулевом весе
+    uint8_t update(DeciCelsius temperature, DeciPercent humidity, Ppm co2, bool co2Valid = true);
+
+    int16_t getError() const { return lastError; }
+    int16_t getOutput() const { return output; }
+};
+
+#endif
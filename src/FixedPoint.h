@@ -0,0 +1,103 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <Arduino.h>
+
+// Значение с фиксированной запятой: хранится raw = value * SCALE.
+// У AVR нет FPU, поэтому все показания и пороги держим в целых.
+// Unit - пустая метка величины: величины с одинаковым T и SCALE все равно
+// разные типы, и ppm не сравнить с миллиметрами.
+template <typename T, int16_t SCALE, class Unit>
+class Fixed
+{
+private:
+    T raw;
+
+    constexpr Fixed(T raw, bool) : raw(raw) {}
+
+public:
+    typedef T RawType;
+    static const int16_t scale = SCALE;
+
+    constexpr Fixed() : raw(0) {}
+
+    static constexpr Fixed fromRaw(T raw) { return Fixed(raw, true); }
+    static constexpr Fixed fromInt(int32_t value) { return Fixed(static_cast<T>(value * SCALE), true); }
+    // fromParts(23, 5) для SCALE 10 -> 23.5
+    static constexpr Fixed fromParts(int32_t whole, int32_t fraction)
+    {
+        return Fixed(static_cast<T>(whole * SCALE + (whole < 0 ? -fraction : fraction)), true);
+    }
+
+    constexpr T getRaw() const { return raw; }
+    // Целая часть с округлением к ближайшему
+    constexpr int32_t toInt() const
+    {
+        return static_cast<int32_t>(raw) < 0 ? (static_cast<int32_t>(raw) - SCALE / 2) / SCALE
+                                             : (static_cast<int32_t>(raw) + SCALE / 2) / SCALE;
+    }
+
+    constexpr bool operator==(Fixed other) const { return raw == other.raw; }
+    constexpr bool operator!=(Fixed other) const { return raw != other.raw; }
+    constexpr bool operator<(Fixed other) const { return raw < other.raw; }
+    constexpr bool operator<=(Fixed other) const { return raw <= other.raw; }
+    constexpr bool operator>(Fixed other) const { return raw > other.raw; }
+    constexpr bool operator>=(Fixed other) const { return raw >= other.raw; }
+
+    constexpr Fixed operator+(Fixed other) const { return Fixed(static_cast<T>(raw + other.raw), true); }
+    constexpr Fixed operator-(Fixed other) const { return Fixed(static_cast<T>(raw - other.raw), true); }
+};
+
+struct TemperatureUnit {};
+struct HumidityUnit {};
+struct IlluminanceUnit {};
+struct ConcentrationUnit {};
+struct LengthUnit {};
+struct VolumeUnit {};
+
+typedef Fixed<int16_t, 10, TemperatureUnit> DeciCelsius;  // 0.1 °C
+typedef Fixed<uint16_t, 10, HumidityUnit> DeciPercent;    // 0.1 %
+typedef Fixed<uint32_t, 1, IlluminanceUnit> Lux;          // до 120 клк
+typedef Fixed<uint16_t, 1, ConcentrationUnit> Ppm;        // eCO2
+typedef Fixed<uint16_t, 1, LengthUnit> Millimetres;
+typedef Fixed<uint32_t, 1, VolumeUnit> Millilitres;
+
+// <type_traits> в avr-gcc нет
+template <class A, class B>
+struct SameFixedType
+{
+    static const bool value = false;
+};
+template <class A>
+struct SameFixedType<A, A>
+{
+    static const bool value = true;
+};
+static_assert(!SameFixedType<Ppm, Millimetres>::value, "units with equal storage must stay distinct types");
+static_assert(!SameFixedType<Lux, Millilitres>::value, "units with equal storage must stay distinct types");
+
+// Печать "целая.дробная" без float
+template <typename T, int16_t SCALE, class Unit>
+size_t printFixed(Print& out, Fixed<T, SCALE, Unit> value)
+{
+    int32_t raw = value.getRaw();
+    size_t n = 0;
+    if (raw < 0)
+    {
+        n += out.print('-');
+        raw = -raw;
+    }
+    n += out.print(raw / SCALE);
+    if (SCALE > 1)
+    {
+        int32_t fraction = raw % SCALE;
+        n += out.print('.');
+        for (int32_t digit = SCALE / 10; digit > 0; digit /= 10)
+        {
+            n += out.print(static_cast<char>('0' + (fraction / digit) % 10));
+        }
+    }
+    return n;
+}
+
+#endif
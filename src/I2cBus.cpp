@@ -0,0 +1,209 @@
+#include "I2cBus.h"
+
+static const char nameVeml7700[] PROGMEM = "veml7700";
+static const char nameAht20[] PROGMEM = "aht20";
+static const char nameEns160[] PROGMEM = "ens160";
+static const char nameDs1307[] PROGMEM = "ds1307";
+static const char nameLcd[] PROGMEM = "lcd";
+static const char* const deviceNames[] PROGMEM = {nameVeml7700, nameAht20, nameEns160, nameDs1307, nameLcd};
+static const uint8_t deviceAddresses[] PROGMEM = {0x10, 0x38, 0x53, 0x68, 0x27};
+
+// Устройства, которым можно 400 кГц
+static const uint8_t FAST_DEVICES =
+    (1 << I2cBus::DEV_VEML7700) | (1 << I2cBus::DEV_AHT20) | (1 << I2cBus::DEV_ENS160);
+
+I2cBus::Stats I2cBus::stats[DEVICE_COUNT];
+uint32_t I2cBus::clockHz = 0;
+uint32_t I2cBus::started = 0;
+uint16_t I2cBus::recoveries = 0;
+bool I2cBus::stuck = false;
+uint32_t I2cBus::lastAttempt = 0;
+
+uint8_t I2cBus::addressOf(Device device)
+{
+    return pgm_read_byte(&deviceAddresses[device]);
+}
+
+uint32_t I2cBus::clockOf(Device device)
+{
+    return (FAST_DEVICES & (1 << device)) ? FAST_CLOCK_HZ : STANDARD_CLOCK_HZ;
+}
+
+void I2cBus::begin()
+{
+    // Ведомый мог остаться посреди байта после сброса контроллера
+    recover();
+}
+
+bool I2cBus::select(Device device)
+{
+    if (stuck)
+    {
+        uint32_t now = millis();
+        if (now - lastAttempt < STUCK_RETRY_MS)
+            return false;
+        lastAttempt = now;
+        if (!recover())
+            return false;
+    }
+
+    uint32_t clock = clockOf(device);
+    if (clock != clockHz)
+    {
+        Wire.setClock(clock);
+        clockHz = clock;
+    }
+    started = micros();
+    return true;
+}
+
+bool I2cBus::finish(Device device, bool ok)
+{
+    Stats& s = stats[device];
+    uint32_t elapsed = micros() - started;
+    s.lastUs = elapsed > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(elapsed);
+    if (s.lastUs > s.maxUs)
+        s.maxUs = s.lastUs;
+    s.transactions++;
+
+    bool timedOut = Wire.getWireTimeoutFlag();
+    if (timedOut)
+    {
+        Wire.clearWireTimeoutFlag();
+        s.timeouts++;
+        if (!stuck)
+        {
+            LOG_WARN(BUS, EV_I2C_TIMEOUT, "I2C timeout, device", device);
+        }
+    }
+    else if (!ok)
+    {
+        s.errors++;
+    }
+
+    // Таймаут или SDA внизу после ошибки - ведомый держит шину
+    if (timedOut || (!ok && digitalRead(SDA) == LOW))
+    {
+        if (!recover())
+        {
+            stuck = true;
+            lastAttempt = millis();
+            LOG_ERROR(BUS, EV_I2C_STUCK, "I2C bus stuck, device", device);
+        }
+    }
+    return ok && !timedOut;
+}
+
+bool I2cBus::recover()
+{
+    Wire.end();
+
+    // Открытый сток: линию прижимаем выходом с нулем, отпускаем входом без подтяжки
+    pinMode(SDA, INPUT);
+    pinMode(SCL, INPUT);
+    digitalWrite(SDA, LOW);
+    digitalWrite(SCL, LOW);
+
+    uint8_t clocks = 0;
+    while (digitalRead(SDA) == LOW && clocks < RECOVERY_CLOCKS)
+    {
+        pinMode(SCL, OUTPUT);
+        delayMicroseconds(5);
+        pinMode(SCL, INPUT);
+        delayMicroseconds(5);
+        clocks++;
+    }
+
+    // STOP: SDA вверх при поднятой SCL
+    pinMode(SDA, OUTPUT);
+    delayMicroseconds(5);
+    pinMode(SDA, INPUT);
+    delayMicroseconds(5);
+    bool released = digitalRead(SDA) == HIGH && digitalRead(SCL) == HIGH;
+
+    Wire.begin();
+    Wire.setWireTimeout(TIMEOUT_US, true);
+    clockHz = 0;
+
+    if (clocks > 0)
+        recoveries++;
+    if (released && (clocks > 0 || stuck))
+    {
+        stuck = false;
+        LOG_INFO(BUS, EV_I2C_RECOVERED, "I2C bus recovered, clocks", clocks);
+    }
+    return released;
+}
+
+bool I2cBus::write(Device device, const uint8_t* data, uint8_t len)
+{
+    if (!select(device))
+        return false;
+    Wire.beginTransmission(addressOf(device));
+    Wire.write(data, len);
+    return finish(device, Wire.endTransmission() == 0);
+}
+
+bool I2cBus::write(Device device, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+    if (!select(device))
+        return false;
+    Wire.beginTransmission(addressOf(device));
+    Wire.write(reg);
+    Wire.write(data, len);
+    return finish(device, Wire.endTransmission() == 0);
+}
+
+bool I2cBus::read(Device device, uint8_t* data, uint8_t len)
+{
+    if (!select(device))
+        return false;
+    bool ok = Wire.requestFrom(addressOf(device), len) == len;
+    for (uint8_t i = 0; ok && i < len; i++)
+    {
+        data[i] = Wire.read();
+    }
+    return finish(device, ok);
+}
+
+bool I2cBus::readRegisters(Device device, uint8_t reg, uint8_t* data, uint8_t len, bool repeatedStart)
+{
+    if (!select(device))
+        return false;
+    uint8_t address = addressOf(device);
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    bool ok = Wire.endTransmission(!repeatedStart) == 0 && Wire.requestFrom(address, len) == len;
+    for (uint8_t i = 0; ok && i < len; i++)
+    {
+        data[i] = Wire.read();
+    }
+    return finish(device, ok);
+}
+
+void I2cBus::dump(Print& out)
+{
+    out.print(F("i2c: recoveries "));
+    out.print(recoveries);
+    out.println(stuck ? F(", stuck") : F(""));
+    for (uint8_t i = 0; i < DEVICE_COUNT; i++)
+    {
+        const Stats& s = stats[i];
+        out.print(reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&deviceNames[i])));
+        out.print(F(" 0x"));
+        out.print(pgm_read_byte(&deviceAddresses[i]), HEX);
+        out.print(F(" @"));
+        out.print(clockOf(static_cast<Device>(i)) / 1000UL);
+        out.print(F("k tx "));
+        out.print(s.transactions);
+        out.print(F(" err "));
+        out.print(s.errors);
+        out.print(F(" timeout "));
+        out.print(s.timeouts);
+        out.print(F(" last "));
+        out.print(s.lastUs);
+        out.print(F(" us max "));
+        out.print(s.maxUs);
+        out.println(F(" us"));
+    }
+}
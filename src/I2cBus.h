@@ -0,0 +1,84 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "Log.h"
+
+// Общая шина I2C всех устройств. Перед обменом выставляется частота устройства
+// (400 кГц, если оно умеет, DS1307 и PCF8574 - только 100 кГц), каждое ожидание
+// в Wire ограничено TIMEOUT_US. После таймаута или при SDA, прижатой к земле,
+// шина восстанавливается: до 9 импульсов SCL, пока ведомый не отпустит SDA,
+// затем STOP и новая инициализация Wire. По каждому устройству считаются
+// обмены, ошибки, таймауты и время обмена. Если ведомый так и не отпустил
+// шину, обмены пропускаются, а восстановление повторяется раз в STUCK_RETRY_MS.
+//
+// Свои драйверы обмениваются через read()/write()/readRegisters(); вызовы
+// сторонних библиотек оборачиваются в if (select()) { ... finish() }.
+class I2cBus
+{
+public:
+    enum Device : uint8_t
+    {
+        DEV_VEML7700,
+        DEV_AHT20,
+        DEV_ENS160,
+        DEV_DS1307,
+        DEV_LCD,
+        DEVICE_COUNT
+    };
+
+    static const uint32_t FAST_CLOCK_HZ = 400000UL;
+    static const uint32_t STANDARD_CLOCK_HZ = 100000UL;
+    static const uint16_t TIMEOUT_US = 2000;  // самый длинный свой обмен - ~1 мс на 100 кГц
+    static const uint8_t RECOVERY_CLOCKS = 9;
+    static const uint16_t STUCK_RETRY_MS = 1000;
+
+    struct Stats
+    {
+        uint32_t transactions;
+        uint16_t errors;    // NACK, короткий ответ
+        uint16_t timeouts;
+        uint16_t lastUs;
+        uint16_t maxUs;
+    };
+
+private:
+    static Stats stats[DEVICE_COUNT];
+    static uint32_t clockHz;
+    static uint32_t started;
+    static uint16_t recoveries;
+    static bool stuck;  // восстановить не удалось, в журнал уже записано
+    static uint32_t lastAttempt;
+
+    static uint8_t addressOf(Device device);
+    static uint32_t clockOf(Device device);
+
+public:
+    static void begin();
+
+    // Обмен целиком: выбрать устройство, передать, учесть результат
+    static bool write(Device device, const uint8_t* data, uint8_t len);
+    // Запись регистра: адрес регистра, затем данные
+    static bool write(Device device, uint8_t reg, const uint8_t* data, uint8_t len);
+    static bool read(Device device, uint8_t* data, uint8_t len);
+    // Адрес регистра, затем чтение; repeatedStart - без STOP между ними
+    static bool readRegisters(Device device, uint8_t reg, uint8_t* data, uint8_t len, bool repeatedStart);
+
+    // Для сторонних библиотек: select() перед их вызовами, finish() после.
+    // false - шина стоит, обмен пропустить (finish() тогда не вызывать)
+    static bool select(Device device);
+    static bool finish(Device device, bool ok);
+    // begin() библиотеки сам вызвал Wire.begin() и вернул 100 кГц
+    static void wireRestarted() { clockHz = 0; }
+
+    // Освободить шину импульсами SCL. true - SDA и SCL снова в единице
+    static bool recover();
+
+    static const Stats& getStats(Device device) { return stats[device]; }
+    static uint16_t getRecoveries() { return recoveries; }
+    static bool isStuck() { return stuck; }
+    static void dump(Print& out);
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include "Irrigation.h"
+#include "RtcNvram.h"
+
+static const uint32_t SECONDS_PER_DAY = 86400UL;
+
+Irrigation::Irrigation(DeviceManager& devices, const Config& config) : devices(devices), config(config)
+{
+    state = STATE_IDLE;
+    block = BLOCK_NONE;
+    stateStart = 0;
+    lastCycleEnd = 0;
+    cycleDone = false;
+    requestedMl = 0;
+    pulses = 0;
+    pulseMl = 0;
+    cycleMl = 0;
+    todayMl = 0;
+    today = 0;
+    epoch = 0;
+}
+
+void Irrigation::begin(uint32_t now)
+{
+    // Пока не доказано обратное, считаем, что цикл только что был
+    uint32_t started = millis();
+    cycleDone = true;
+    lastCycleEnd = started;
+    epoch = now;
+
+    uint8_t data[NVRAM_SIZE];
+    if (now == 0 || !RtcNvram::read(RtcNvram::IRRIGATION_OFFSET, data, sizeof(data)))
+        return;
+
+    uint8_t check = 0;
+    for (uint8_t i = 0; i < NVRAM_SIZE - 1; i++)
+    {
+        check ^= data[i];
+    }
+    if (data[0] != NVRAM_MAGIC || check != data[NVRAM_SIZE - 1])
+        return;
+
+    uint32_t lastPump = static_cast<uint32_t>(data[4]) | (static_cast<uint32_t>(data[5]) << 8) |
+                        (static_cast<uint32_t>(data[6]) << 16) | (static_cast<uint32_t>(data[7]) << 24);
+    if (lastPump > now)
+        return;  // часы перевели назад - интервал отсчитываем от старта
+    uint32_t elapsed = now - lastPump;
+
+    // Суточный счет - если сохранен меньше суток назад; день месяца сверит update()
+    if (elapsed < SECONDS_PER_DAY)
+    {
+        today = data[1];
+        todayMl = static_cast<uint16_t>(data[2] | (data[3] << 8));
+    }
+    if (elapsed < config.minIntervalMs / 1000UL)
+        lastCycleEnd = started - elapsed * 1000UL;
+    else
+        cycleDone = false;
+}
+
+void Irrigation::save(uint16_t dayMl) const
+{
+    if (epoch == 0)
+        return;
+
+    uint8_t data[NVRAM_SIZE];
+    data[0] = NVRAM_MAGIC;
+    data[1] = today;
+    data[2] = static_cast<uint8_t>(dayMl);
+    data[3] = static_cast<uint8_t>(dayMl >> 8);
+    data[4] = static_cast<uint8_t>(epoch);
+    data[5] = static_cast<uint8_t>(epoch >> 8);
+    data[6] = static_cast<uint8_t>(epoch >> 16);
+    data[7] = static_cast<uint8_t>(epoch >> 24);
+    uint8_t check = 0;
+    for (uint8_t i = 0; i < NVRAM_SIZE - 1; i++)
+    {
+        check ^= data[i];
+    }
+    data[NVRAM_SIZE - 1] = check;
+    RtcNvram::write(RtcNvram::IRRIGATION_OFFSET, data, sizeof(data));
+}
+
+void Irrigation::request(uint16_t ml)
+{
+    if (state == STATE_IDLE)
+    {
+        requestedMl = ml;
+    }
+}
+
+void Irrigation::abort()
+{
+    if (state == STATE_IDLE)
+    {
+        requestedMl = 0;
+        return;
+    }
+    if (state == STATE_PULSE)
+    {
+        // Сколько успело уйти, неизвестно: для лимита считаем порцию целиком
+        devices.stopPump();
+        cycleMl += pulseMl;
+        todayMl += pulseMl;
+    }
+    finishCycle(millis());
+}
+
+Irrigation::Block Irrigation::checkPulse(const Inputs& inputs) const
+{
+    if (!inputs.soilValid)
+        return BLOCK_SOIL_SENSOR;
+    if (!inputs.waterValid || inputs.water.getRaw() < static_cast<uint32_t>(config.pulseMl) + config.tankReserveMl)
+        return BLOCK_TANK;
+    if (static_cast<uint32_t>(todayMl) + config.pulseMl > config.dailyCapMl)
+        return BLOCK_DAILY_CAP;
+    return BLOCK_NONE;
+}
+
+bool Irrigation::startPulse(const Inputs& inputs, uint32_t now)
+{
+    Block reason = checkPulse(inputs);
+    setBlock(reason);
+    if (reason != BLOCK_NONE)
+        return false;
+
+    pulseMl = config.pulseMl;
+    if (requestedMl > 0 && requestedMl - cycleMl < pulseMl)
+        pulseMl = requestedMl - cycleMl;
+    devices.startPump(pulseMl);
+    // Порция засчитывается заранее: сброс посреди нее не должен дать лишнюю
+    save(todayMl + pulseMl);
+    state = STATE_PULSE;
+    stateStart = now;
+    return true;
+}
+
+void Irrigation::finishCycle(uint32_t now)
+{
+    state = STATE_IDLE;
+    lastCycleEnd = now;
+    cycleDone = true;
+    requestedMl = 0;
+    save(todayMl);
+    LOG_INFO(MAIN, EV_IRRIGATION_DONE, "Irrigation done, ml", cycleMl);
+}
+
+void Irrigation::setBlock(Block reason)
+{
+    // Пишем в журнал только смену причины, интервал между циклами - штатная пауза
+    if (reason != block && reason != BLOCK_NONE && reason != BLOCK_INTERVAL)
+    {
+        LOG_WARN(MAIN, EV_IRRIGATION_BLOCKED, "Irrigation blocked", reason);
+    }
+    block = reason;
+}
+
+void Irrigation::update(const Inputs& inputs)
+{
+    uint32_t now = millis();
+    epoch = inputs.time;
+    if (inputs.day != today)
+    {
+        today = inputs.day;
+        todayMl = 0;
+    }
+
+    switch (state)
+    {
+    case STATE_IDLE:
+    {
+        bool dry = inputs.soilValid && inputs.soil < config.startBelow;
+        if ((!dry && requestedMl == 0) || devices.isPumpOn())
+        {
+            setBlock(BLOCK_NONE);
+            return;
+        }
+        if (cycleDone && now - lastCycleEnd < config.minIntervalMs)
+        {
+            setBlock(BLOCK_INTERVAL);
+            return;
+        }
+
+        pulses = 0;
+        cycleMl = 0;
+        if (startPulse(inputs, now))
+        {
+            LOG_INFO(MAIN, EV_IRRIGATION_START, "Irrigation start, soil", inputs.soil);
+        }
+        else
+        {
+            // Запрос не откладываем: через сутки или после доливки он уже не к месту
+            requestedMl = 0;
+        }
+        break;
+    }
+
+    case STATE_PULSE:
+        // Порцию отмеряет и останавливает DeviceManager
+        if (devices.isPumpOn())
+            return;
+        pulses++;
+        cycleMl += pulseMl;
+        todayMl += pulseMl;
+        state = STATE_SOAK;
+        stateStart = now;
+        break;
+
+    case STATE_SOAK:
+        if (now - stateStart < config.soakMs)
+            return;
+        // Влажность проверяем только после впитывания, иначе датчик у поверхности врет
+        if ((inputs.soilValid && inputs.soil >= config.stopAt) || pulses >= config.maxPulses ||
+            (requestedMl > 0 && cycleMl >= requestedMl) || !startPulse(inputs, now))
+        {
+            finishCycle(now);
+        }
+        break;
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef IRRIGATION_H
+#define IRRIGATION_H
+
+#include <Arduino.h>
+#include "DeviceManager.h"
+#include "FixedPoint.h"
+#include "Log.h"
+
+// Полив порциями с паузами на впитывание (pulse-and-soak). Цикл начинается,
+// когда почва суше startBelow (или по request()), и чередует порцию насоса
+// с паузой soakMs; после каждой паузы влажность проверяется заново, цикл
+// заканчивается на stopAt, по maxPulses или по лимитам. Насос не включается
+// без исправного датчика почвы, при запасе в баке меньше порции + резерва,
+// сверх суточного лимита и чаще minIntervalMs между циклами.
+// Полито за сутки и время последней порции хранятся в NVRAM часов: сброс
+// (например, просадка питания при пуске насоса) не обнуляет лимиты. Без
+// сохраненной записи после старта сначала выдерживается minIntervalMs.
+// Ничего не ждет: update() вызывается периодически и только переключает состояния.
+class Irrigation
+{
+public:
+    struct Config
+    {
+        uint8_t startBelow;      // %, почва суше - начать цикл
+        uint8_t stopAt;          // %, цикл до этой влажности
+        uint16_t pulseMl;        // порция за одно включение насоса
+        uint32_t soakMs;         // пауза на впитывание после порции
+        uint8_t maxPulses;       // порций за цикл
+        uint16_t dailyCapMl;     // за календарные сутки
+        uint32_t minIntervalMs;  // от конца цикла до начала следующего
+        uint16_t tankReserveMl;  // в баке всегда остается
+    };
+
+    enum State : uint8_t
+    {
+        STATE_IDLE,
+        STATE_PULSE,
+        STATE_SOAK
+    };
+
+    // Почему полив не идет, хотя нужен. Номера пишутся в журнал
+    enum Block : uint8_t
+    {
+        BLOCK_NONE,
+        BLOCK_SOIL_SENSOR,
+        BLOCK_TANK,
+        BLOCK_DAILY_CAP,
+        BLOCK_INTERVAL
+    };
+
+    struct Inputs
+    {
+        uint8_t soil;  // %
+        bool soilValid;
+        Millilitres water;
+        bool waterValid;
+        uint8_t day;   // день месяца, смена дня сбрасывает суточный счет
+        uint32_t time; // unix-время, 0 - часы не идут (тогда в NVRAM не пишем)
+    };
+
+private:
+    static const uint8_t NVRAM_MAGIC = 0x1B;
+    static const uint8_t NVRAM_SIZE = 9;
+
+    DeviceManager& devices;
+    Config config;
+
+    State state;
+    Block block;
+    uint32_t stateStart;
+    uint32_t lastCycleEnd;
+    bool cycleDone;      // был хотя бы один цикл (иначе интервал не отсчитывается)
+    uint16_t requestedMl;  // 0 - цикл по влажности, иначе по request()
+    uint8_t pulses;
+    uint16_t pulseMl;    // объем текущей порции
+    uint16_t cycleMl;
+    uint16_t todayMl;
+    uint8_t today;
+    uint32_t epoch;      // время из последнего update()
+
+    Block checkPulse(const Inputs& inputs) const;
+    bool startPulse(const Inputs& inputs, uint32_t now);
+    void finishCycle(uint32_t now);
+    void setBlock(Block reason);
+    void save(uint16_t dayMl) const;
+
+public:
+    Irrigation(DeviceManager& devices, const Config& config);
+
+    // Восстановить суточный счет и время последней порции из NVRAM часов.
+    // epoch - текущее unix-время, 0 - неизвестно
+    void begin(uint32_t epoch);
+
+    void setConfig(const Config& newConfig) { config = newConfig; }
+    const Config& getConfig() const { return config; }
+
+    // Полить до ml (порциями, с проверкой почвы и лимитов), не дожидаясь сухой почвы
+    void request(uint16_t ml);
+    // Остановить насос и закончить цикл
+    void abort();
+
+    // Шаг автомата, вызывать с периодом около секунды
+    void update(const Inputs& inputs);
+
+    State getState() const { return state; }
+    Block getBlock() const { return block; }
+    bool isActive() const { return state != STATE_IDLE; }
+    uint8_t getPulses() const { return pulses; }
+    uint16_t getCycleMl() const { return cycleMl; }
+    uint16_t getTodayMl() const { return todayMl; }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "LcdFrameBuffer.h"
+#include <Wire.h>
+
+LcdFrameBuffer::LcdFrameBuffer(uint8_t cols, uint8_t rows) : cols(cols), rows(rows)
+{
+    // Выделяется один раз при создании дисплея
+    back = new uint8_t[cols * rows];
+    front = new uint8_t[cols * rows];
+    stale = new uint8_t[(cols * rows + 7) / 8];
+    cursorCol = 0;
+    cursorRow = 0;
+    resumeCol = 0;
+    resumeRow = 0;
+    clear();
+    invalidate();
+}
+
+void LcdFrameBuffer::clear()
+{
+    memset(back, ' ', cols * rows);
+    cursorCol = 0;
+    cursorRow = 0;
+}
+
+void LcdFrameBuffer::setCursor(uint8_t col, uint8_t row)
+{
+    cursorCol = col;
+    cursorRow = row;
+}
+
+size_t LcdFrameBuffer::write(uint8_t c)
+{
+    // Все, что выходит за строку, отбрасывается (без переноса)
+    if (cursorRow >= rows || cursorCol >= cols)
+    {
+        return 0;
+    }
+    back[cursorRow * cols + cursorCol] = c;
+    cursorCol++;
+    return 1;
+}
+
+void LcdFrameBuffer::markCleared()
+{
+    memset(front, ' ', cols * rows);
+    memset(stale, 0, (cols * rows + 7) / 8);
+}
+
+void LcdFrameBuffer::invalidate()
+{
+    memset(stale, 0xFF, (cols * rows + 7) / 8);
+}
+
+uint8_t LcdFrameBuffer::flush(LiquidCrystal_I2C& lcd)
+{
+    uint8_t written = 0;
+
+    // Обход по кругу с места остановки: строка resumeRow проходится дважды,
+    // сначала от resumeCol до конца, в последний раз - от начала до resumeCol
+    for (uint8_t step = 0; step <= rows; step++)
+    {
+        uint8_t row = (resumeRow + step) % rows;
+        uint8_t col = step == 0 ? resumeCol : 0;
+        uint8_t limit = step == rows ? resumeCol : cols;
+        uint16_t first = row * cols;
+        uint8_t* b = back + first;
+        uint8_t* f = front + first;
+
+        while (col < limit)
+        {
+            if (!needsSend(first + col))
+            {
+                col++;
+                continue;
+            }
+
+            // setCursor - такая же команда контроллеру, как символ, и стоит столько же
+            if (written + 1 >= MAX_COMMANDS_PER_FLUSH)
+            {
+                resumeCol = col;
+                resumeRow = row;
+                return written;
+            }
+
+            // Ищем конец серии изменений, допуская короткие промежутки
+            uint8_t start = col;
+            uint8_t end = col + 1;
+            uint8_t gap = 0;
+            uint8_t maxEnd = start + (MAX_COMMANDS_PER_FLUSH - written - 1);
+            if (maxEnd > limit)
+                maxEnd = limit;
+            for (uint8_t i = end; i < maxEnd; i++)
+            {
+                if (needsSend(first + i))
+                {
+                    end = i + 1;
+                    gap = 0;
+                }
+                else if (++gap > MERGE_GAP)
+                {
+                    break;
+                }
+            }
+
+            lcd.setCursor(start, row);
+            for (uint8_t i = start; i < end; i++)
+            {
+                lcd.write(b[i]);
+                f[i] = b[i];
+                stale[(first + i) >> 3] &= ~(1 << ((first + i) & 7));
+#ifdef WIRE_HAS_TIMEOUT
+                // Шина встала: каждый следующий байт ждал бы таймаута целиком
+                if (Wire.getWireTimeoutFlag())
+                {
+                    resumeCol = i + 1 < cols ? i + 1 : 0;
+                    resumeRow = i + 1 < cols ? row : (row + 1) % rows;
+                    return written + 1 + i + 1 - start;
+                }
+#endif
+            }
+            written += 1 + end - start;
+            col = end;
+        }
+    }
+
+    return written;
+}
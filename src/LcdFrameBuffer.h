@@ -0,0 +1,60 @@
+#ifndef LCD_FRAME_BUFFER_H
+#define LCD_FRAME_BUFFER_H
+
+#include <Arduino.h>
+#include "LiquidCrystal_I2C.h"
+
+// Теневой буфер символьного LCD. Экран рисуется в back через обычный Print,
+// flush() сравнивает его с тем, что уже на экране (front), и отправляет
+// только изменившиеся ячейки, склеивая соседние в один setCursor + запись.
+// За один flush() отправляется не больше MAX_COMMANDS_PER_FLUSH команд
+// (символов и setCursor): команда через PCF8574 на 100 кГц стоит ~1.2 мс,
+// и смена страницы целиком заняла бы ~40 мс. Остаток дописывается
+// следующими вызовами с места остановки.
+class LcdFrameBuffer : public Print
+{
+private:
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t* back;   // то, что хотим видеть
+    uint8_t* front;  // то, что сейчас на экране
+    uint8_t* stale;  // битовая карта ячеек, содержимое которых на экране неизвестно
+    uint8_t cursorCol;
+    uint8_t cursorRow;
+    uint8_t resumeCol;  // откуда продолжить следующий flush()
+    uint8_t resumeRow;
+
+    // Неизменившиеся ячейки между двумя изменениями, которые выгоднее
+    // переписать, чем отправлять новый setCursor
+    static const uint8_t MERGE_GAP = 1;
+
+    // Отметки в front не годятся: любой байт - допустимый символ (0xFF - сплошной блок)
+    bool isStale(uint16_t cell) const { return stale[cell >> 3] & (1 << (cell & 7)); }
+    bool needsSend(uint16_t cell) const { return back[cell] != front[cell] || isStale(cell); }
+
+public:
+    static const uint8_t MAX_COMMANDS_PER_FLUSH = 6;
+
+    LcdFrameBuffer(uint8_t cols, uint8_t rows);
+
+    // Очистить back (без обмена с дисплеем)
+    void clear();
+    void setCursor(uint8_t col, uint8_t row);
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    // Дисплей был очищен аппаратно - синхронизировать front
+    void markCleared();
+    // Принудительно перерисовать все ячейки при следующем flush()
+    void invalidate();
+
+    // Отправить изменения на дисплей, не больше MAX_COMMANDS_PER_FLUSH команд.
+    // Возвращает число отправленных; после таймаута шины I2C прекращает вывод
+    uint8_t flush(LiquidCrystal_I2C& lcd);
+
+    uint8_t getCols() const { return cols; }
+    uint8_t getRows() const { return rows; }
+};
+
+#endif
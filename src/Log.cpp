@@ -0,0 +1,168 @@
+#include "Log.h"
+
+#ifdef __AVR__
+#define LOG_NOINIT __attribute__((section(".noinit")))
+#else
+#define LOG_NOINIT
+#endif
+
+// Кольцо трассировки не обнуляется при старте, целостность проверяется по magic
+static struct
+{
+    uint16_t magic;
+    uint8_t head;
+    uint8_t count;
+    Log::TraceEntry entries[Log::TRACE_SIZE];
+} trace LOG_NOINIT;
+static_assert(sizeof(trace) == Log::TRACE_BYTES, "Log::TRACE_BYTES is reported by the 'm' command");
+
+#ifdef __AVR__
+// Причина сброса. Optiboot сам читает и обнуляет MCUSR, а флаги передает в r2;
+// без загрузчика они остаются в MCUSR. Снимаем в .init0, пока crt не тронул
+// регистры, и сразу обнуляем MCUSR. На асме: r1 еще не обнулен, стека нет
+static uint8_t resetFlags LOG_NOINIT;
+
+static void saveResetFlags() __attribute__((naked, used, section(".init0")));
+static void saveResetFlags()
+{
+    __asm volatile("    in r24, %0\n"
+                   "    tst r24\n"
+                   "    brne 1f\n"
+                   "    mov r24, r2\n"
+                   "1:  sts %1, r24\n"
+                   "    ldi r24, 0\n"
+                   "    out %0, r24\n"
+                   :
+                   : "I"(_SFR_IO_ADDR(MCUSR)), "i"(&resetFlags));
+}
+#endif
+
+static const char levelLetters[] PROGMEM = "-EWID";
+
+static const char moduleMain[] PROGMEM = "MAIN";
+static const char moduleSensors[] PROGMEM = "SENSORS";
+static const char moduleDevices[] PROGMEM = "DEVICES";
+static const char moduleDisplay[] PROGMEM = "DISPLAY";
+static const char moduleStorage[] PROGMEM = "STORAGE";
+static const char moduleBus[] PROGMEM = "BUS";
+static const char* const moduleNames[] PROGMEM = {moduleMain,    moduleSensors, moduleDevices,
+                                                  moduleDisplay, moduleStorage, moduleBus};
+
+HardwareSerial* Log::port = nullptr;
+bool Log::blocking = true;
+uint16_t Log::droppedLines = 0;
+
+void Log::begin(HardwareSerial& serial)
+{
+    port = &serial;
+
+    if (trace.magic != TRACE_MAGIC || trace.head >= TRACE_SIZE || trace.count > TRACE_SIZE)
+    {
+        clearTrace();
+    }
+
+    uint8_t resetCause = 0;
+#ifdef __AVR__
+    resetCause = resetFlags;
+#endif
+    record(LOG_LEVEL_INFO, LOG_MODULE_MAIN, EV_BOOT, resetCause);
+}
+
+void Log::clearTrace()
+{
+    trace.magic = TRACE_MAGIC;
+    trace.head = 0;
+    trace.count = 0;
+}
+
+void Log::record(uint8_t level, uint8_t module, uint8_t event, int16_t arg)
+{
+    TraceEntry& entry = trace.entries[trace.head];
+    entry.timeMs = millis();
+    entry.event = event;
+    entry.levelModule = static_cast<uint8_t>((level << 5) | (module & 0x1F));
+    entry.arg = arg;
+
+    trace.head = (trace.head + 1) % TRACE_SIZE;
+    if (trace.count < TRACE_SIZE)
+        trace.count++;
+}
+
+void Log::write(uint8_t level, uint8_t module, uint8_t event, const __FlashStringHelper* text)
+{
+    record(level, module, event | NO_ARG_FLAG, 0);
+    printLine(level, module, text, nullptr);
+}
+
+void Log::write(uint8_t level, uint8_t module, uint8_t event, const __FlashStringHelper* text, int16_t arg)
+{
+    record(level, module, event, arg);
+    printLine(level, module, text, &arg);
+}
+
+void Log::printLine(uint8_t level, uint8_t module, const __FlashStringHelper* text, const int16_t* arg)
+{
+    if (port == nullptr)
+        return;
+
+    // "I SENSORS " + текст + " -32768\r\n"
+    PGM_P name = reinterpret_cast<PGM_P>(pgm_read_ptr(&moduleNames[module]));
+    uint8_t length = 2 + strlen_P(name) + 1 + strlen_P(reinterpret_cast<PGM_P>(text)) + (arg ? 7 : 0) + 2;
+    if (!blocking && port->availableForWrite() < length)
+    {
+        // Строка потеряна, но событие уже в кольце
+        if (droppedLines < UINT16_MAX)
+            droppedLines++;
+        return;
+    }
+
+    port->write(pgm_read_byte(&levelLetters[level]));
+    port->write(' ');
+    port->print(reinterpret_cast<const __FlashStringHelper*>(name));
+    port->write(' ');
+    port->print(text);
+    if (arg)
+    {
+        port->write(' ');
+        port->print(*arg);
+    }
+    port->println();
+}
+
+void Log::printEntry(Print& out, const TraceEntry& entry)
+{
+    uint8_t level = entry.levelModule >> 5;
+    uint8_t module = entry.levelModule & 0x1F;
+
+    out.print(entry.timeMs);
+    out.write(' ');
+    out.write(level <= LOG_LEVEL_DEBUG ? pgm_read_byte(&levelLetters[level]) : '?');
+    out.write(' ');
+    if (module < sizeof(moduleNames) / sizeof(moduleNames[0]))
+        out.print(reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&moduleNames[module])));
+    else
+        out.print(module);
+    out.print(F(" ev "));
+    out.print(entry.event & ~NO_ARG_FLAG);
+    if (!(entry.event & NO_ARG_FLAG))
+    {
+        out.print(F(" arg "));
+        out.print(entry.arg);
+    }
+    out.println();
+}
+
+void Log::dumpTrace(Print& out)
+{
+    out.print(F("trace "));
+    out.print(trace.count);
+    out.print(F(", dropped lines "));
+    out.println(droppedLines);
+
+    uint8_t index = (trace.head + TRACE_SIZE - trace.count) % TRACE_SIZE;
+    for (uint8_t i = 0; i < trace.count; i++)
+    {
+        printEntry(out, trace.entries[index]);
+        index = (index + 1) % TRACE_SIZE;
+    }
+}
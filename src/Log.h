@@ -0,0 +1,141 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+// Журнал с уровнями на модуль. Уровень модуля задается при сборке, например
+// -DLOG_LEVEL_SENSORS=LOG_LEVEL_WARN. Сообщения ниже уровня отсекаются константным
+// условием и вместе со строкой (F()) выбрасываются компоновщиком.
+//
+// Каждое сообщение попадает в кольцо трассировки в RAM (событие, время, аргумент)
+// и, если в буфере UART есть место, текстом в Serial. Кольцо лежит в .noinit
+// и переживает сброс по watchdog, его можно вывести после сбоя.
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL_MAIN
+#define LOG_LEVEL_MAIN LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_SENSORS
+#define LOG_LEVEL_SENSORS LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_DEVICES
+#define LOG_LEVEL_DEVICES LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_DISPLAY
+#define LOG_LEVEL_DISPLAY LOG_LEVEL_WARN
+#endif
+#ifndef LOG_LEVEL_STORAGE
+#define LOG_LEVEL_STORAGE LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_BUS
+#define LOG_LEVEL_BUS LOG_LEVEL_INFO
+#endif
+
+// Номера модулей для записи в кольцо (не больше 32)
+#define LOG_MODULE_MAIN 0
+#define LOG_MODULE_SENSORS 1
+#define LOG_MODULE_DEVICES 2
+#define LOG_MODULE_DISPLAY 3
+#define LOG_MODULE_STORAGE 4
+#define LOG_MODULE_BUS 5
+
+// Коды событий. Номера не меняем: по ним разбирается дамп кольца.
+enum LogEvent : uint8_t
+{
+    EV_BOOT = 1,          // arg: причина сброса (MCUSR)
+    EV_VEML7700_OK = 2,
+    EV_VEML7700_FAIL = 3,
+    EV_AHT20_OK = 4,
+    EV_AHT20_FAIL = 5,
+    EV_AHT20_ERROR = 6,   // ошибка шины/CRC/таймаут при замере
+    EV_ENS160_OK = 7,
+    EV_ENS160_FAIL = 8,
+    EV_SOIL_OK = 9,       // arg: пин
+    EV_HCSR04_OK = 10,
+    EV_RTC_OK = 11,
+    EV_RTC_FAIL = 12,
+    EV_RTC_READ_FAIL = 13,   // arg: неудачных попыток подряд
+    EV_EEPROM_LOG_OK = 14,    // arg: целых записей
+    EV_EEPROM_LOG_DROP = 15,  // arg: всего потеряно записей
+    EV_RTC_SYNC = 16,         // arg: поправка, мс
+    EV_RTC_DRIFT = 17,        // arg: оценка дрейфа, ppm
+    EV_RULES_OK = 18,         // arg: действующих правил
+    EV_RULES_REJECTED = 19,   // arg: принято правил до ошибки
+    EV_IRRIGATION_START = 20,    // arg: влажность почвы, %
+    EV_IRRIGATION_DONE = 21,     // arg: полито за цикл, мл
+    EV_IRRIGATION_BLOCKED = 22,  // arg: Irrigation::Block
+    EV_PUMP_FLOW = 23,           // arg: оценка производительности насоса, мл/мин
+    EV_PUMP_FLOW_REJECTED = 24,  // arg: неправдоподобный замер, мл/мин
+    EV_DLI_DAY = 25,             // arg: DLI прошедших суток, 0.1 моль/м²
+    EV_I2C_TIMEOUT = 26,         // arg: I2cBus::Device
+    EV_I2C_RECOVERED = 27,       // arg: импульсов SCL понадобилось
+    EV_I2C_STUCK = 28,           // arg: I2cBus::Device, на котором шина встала
+    EV_SENSOR_LOST = 29,         // arg: SensorHealth::Sensor
+    EV_SENSOR_RESTORED = 30,     // arg: SensorHealth::Sensor
+    EV_MEMORY_LOW = 31,          // arg: нетронутых байт между кучей и стеком
+    EV_TASK_REJECTED = 32,       // arg: задач в таблице планировщика
+};
+
+#define LOG_AT(level, module, event, ...)                                                       \
+    do                                                                                          \
+    {                                                                                           \
+        if ((level) <= LOG_LEVEL_##module)                                                      \
+            Log::write((level), LOG_MODULE_##module, (event), __VA_ARGS__);                     \
+    } while (0)
+
+// LOG_INFO(SENSORS, EV_SOIL_OK, "Soil sensor OK, pin", pin) - аргумент необязателен
+#define LOG_ERROR(module, event, text, ...) LOG_AT(LOG_LEVEL_ERROR, module, event, F(text), ##__VA_ARGS__)
+#define LOG_WARN(module, event, text, ...) LOG_AT(LOG_LEVEL_WARN, module, event, F(text), ##__VA_ARGS__)
+#define LOG_INFO(module, event, text, ...) LOG_AT(LOG_LEVEL_INFO, module, event, F(text), ##__VA_ARGS__)
+#define LOG_DEBUG(module, event, text, ...) LOG_AT(LOG_LEVEL_DEBUG, module, event, F(text), ##__VA_ARGS__)
+
+class Log
+{
+public:
+    static const uint8_t TRACE_SIZE = 16;
+
+    struct TraceEntry
+    {
+        uint32_t timeMs;
+        uint8_t event;
+        uint8_t levelModule;  // уровень в старших 3 битах, модуль в младших 5
+        int16_t arg;
+    };
+    // Кольцо в .noinit: magic, head, count и записи
+    static const uint16_t TRACE_BYTES = 4 + TRACE_SIZE * sizeof(TraceEntry);
+
+private:
+    static const uint16_t TRACE_MAGIC = 0x4C47;
+    static const uint8_t NO_ARG_FLAG = 0x80;  // в event: аргумента не было
+
+    static HardwareSerial* port;
+    static bool blocking;
+    static uint16_t droppedLines;
+
+    static void record(uint8_t level, uint8_t module, uint8_t event, int16_t arg);
+    static void printLine(uint8_t level, uint8_t module, const __FlashStringHelper* text, const int16_t* arg);
+    static void printEntry(Print& out, const TraceEntry& entry);
+
+public:
+    // Подключить вывод и отметить загрузку в кольце
+    static void begin(HardwareSerial& serial);
+
+    // В setup() ждать освобождения UART можно, в рабочем цикле - нет
+    static void setBlocking(bool enabled) { blocking = enabled; }
+
+    static void write(uint8_t level, uint8_t module, uint8_t event, const __FlashStringHelper* text);
+    static void write(uint8_t level, uint8_t module, uint8_t event, const __FlashStringHelper* text, int16_t arg);
+
+    // Кольцо от старых записей к новым, включая записи до последнего сброса
+    static void dumpTrace(Print& out);
+    static void clearTrace();
+
+    static uint16_t getDroppedLines() { return droppedLines; }
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "MemoryMonitor.h"
+
+uint16_t MemoryMonitor::unused = UINT16_MAX;
+bool MemoryMonitor::warned = false;
+
+#ifdef __AVR__
+
+// Символы компоновщика, crt и malloc() из avr-libc
+extern "C"
+{
+extern uint8_t __data_start;
+extern uint8_t _end;          // конец .noinit, начало кучи
+extern uint8_t __stack;       // RAMEND
+extern char* __brkval;        // конец кучи, 0 - malloc() еще не вызывался
+
+struct __freelist
+{
+    size_t sz;
+    struct __freelist* nx;
+};
+extern struct __freelist* __flp;
+}
+
+// Закраска до инициализации стека и конструкторов: на асме, потому что r1 еще не обнулен
+static void paintStack() __attribute__((naked, used, section(".init1")));
+static void paintStack()
+{
+    __asm volatile("    ldi r30, lo8(_end)\n"
+                   "    ldi r31, hi8(_end)\n"
+                   "    ldi r24, %0\n"
+                   "    ldi r25, hi8(__stack)\n"
+                   "    rjmp 2f\n"
+                   "1:  st Z+, r24\n"
+                   "2:  cpi r30, lo8(__stack)\n"
+                   "    cpc r31, r25\n"
+                   "    brlo 1b\n"
+                   "    breq 1b\n"
+                   :
+                   : "M"(MemoryMonitor::CANARY));
+}
+
+static uint8_t* heapEnd()
+{
+    return __brkval != 0 ? reinterpret_cast<uint8_t*>(__brkval) : &_end;
+}
+
+// Отметка стека опускается только вниз: выше нее байты уже тронуты, смотреть
+// их снова незачем. Проход от кучи до отметки ведется с позиции scanPos
+static const uint8_t* lowMark = 0;
+static const uint8_t* scanPos = 0;
+
+// true - проход закончен, в unusedOut нетронутые байты
+static bool scanStack(uint16_t maxBytes, uint16_t& unusedOut)
+{
+    // Стек растет вниз, поэтому первый измененный байт над кучей - его нижняя граница.
+    // Вершину стека берем из SP: ниже нее байты этого вызова
+    const uint8_t* bottom = heapEnd();
+    const uint8_t* top = reinterpret_cast<const uint8_t*>(SP);
+    if (lowMark == 0 || top < lowMark)
+        lowMark = top;
+    if (scanPos < bottom)
+        scanPos = bottom;
+    if (scanPos > lowMark)
+        scanPos = lowMark;
+
+    const uint8_t* end = static_cast<uint16_t>(lowMark - scanPos) > maxBytes ? scanPos + maxBytes : lowMark;
+    while (scanPos < end && *scanPos == MemoryMonitor::CANARY)
+        scanPos++;
+    if (scanPos < end)
+        lowMark = scanPos;
+    if (scanPos < lowMark)
+        return false;
+
+    unusedOut = lowMark > bottom ? static_cast<uint16_t>(lowMark - bottom) : 0;
+    scanPos = bottom;
+    return true;
+}
+
+void MemoryMonitor::update()
+{
+    if (!scanStack(SCAN_BYTES, unused))
+        return;
+
+    if (unused < LOW_MARGIN && !warned)
+    {
+        warned = true;
+        LOG_WARN(MAIN, EV_MEMORY_LOW, "RAM low, bytes", unused);
+    }
+}
+
+bool MemoryMonitor::getStats(Stats& out)
+{
+    scanStack(UINT16_MAX, unused);
+    out.staticSize = static_cast<uint16_t>(&_end - &__data_start);
+    out.heapSize = static_cast<uint16_t>(heapEnd() - &_end);
+
+    out.heapFree = 0;
+    out.heapLargest = 0;
+    for (const __freelist* block = __flp; block != 0; block = block->nx)
+    {
+        // Освобожденный блок у __brkval avr-libc возвращает в кучу, в списке только дыры
+        out.heapFree += block->sz + sizeof(size_t);
+        if (block->sz > out.heapLargest)
+            out.heapLargest = block->sz;
+    }
+
+    out.stackNow = static_cast<uint16_t>(&__stack - reinterpret_cast<const uint8_t*>(SP));
+    out.stackPeak = static_cast<uint16_t>(&__stack + 1 - heapEnd()) - unused;
+    out.unused = unused;
+    return true;
+}
+
+#else
+
+void MemoryMonitor::update()
+{
+}
+
+bool MemoryMonitor::getStats(Stats&)
+{
+    return false;
+}
+
+#endif
+
+void MemoryMonitor::dump(Print& out)
+{
+    Stats s;
+    if (!getStats(s))
+    {
+        out.println(F("memory stats: AVR only"));
+        return;
+    }
+
+    out.print(F("static "));
+    out.println(s.staticSize);
+    out.print(F("heap "));
+    out.print(s.heapSize);
+    out.print(F(" free "));
+    out.print(s.heapFree);
+    out.print(F(" largest "));
+    out.println(s.heapLargest);
+    out.print(F("stack "));
+    out.print(s.stackNow);
+    out.print(F(" peak "));
+    out.println(s.stackPeak);
+    out.print(F("unused "));
+    out.println(s.unused);
+}
+
+void MemoryMonitor::dumpObjects(Print& out, const ObjectSize* table, uint8_t count)
+{
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        ObjectSize entry;
+        memcpy_P(&entry, &table[i], sizeof(entry));
+        out.print(reinterpret_cast<const __FlashStringHelper*>(entry.name));
+        out.print(' ');
+        out.println(entry.size);
+        total += entry.size;
+    }
+    out.print(F("objects total "));
+    out.println(total);
+
+    // Остальное статическое (строки в RAM, переменные библиотек) и куча - из карты памяти
+    Stats s;
+    if (!getStats(s))
+        return;
+    out.print(F("other static "));
+    out.println(s.staticSize > total ? s.staticSize - total : 0);
+    out.print(F("heap "));
+    out.println(s.heapSize);
+    out.print(F("total "));
+    out.println(s.staticSize + s.heapSize);
+}
@@ -0,0 +1,58 @@
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <Arduino.h>
+#include "Log.h"
+
+// Запас RAM между кучей и стеком. До конструкторов (секция .init1) вся RAM
+// от конца .noinit до вершины стека закрашивается байтом CANARY; update()
+// ищет от конца кучи вверх первый измененный байт - это наибольшая глубина
+// стека с запуска. Проход идет до прежней отметки кусками по SCAN_BYTES
+// и продолжается со следующего вызова, getStats() досматривает его целиком. Куча считается по __brkval и списку свободных блоков
+// avr-libc. Если нетронутых байт осталось меньше LOW_MARGIN, в журнал
+// один раз пишется EV_MEMORY_LOW. Только для AVR: в сборке под хост
+// getStats() возвращает false.
+class MemoryMonitor
+{
+public:
+    static const uint8_t CANARY = 0xC5;
+    static const uint16_t LOW_MARGIN = 128;
+    static const uint16_t SCAN_BYTES = 256;
+
+    struct Stats
+    {
+        uint16_t staticSize;   // .data + .bss + .noinit
+        uint16_t heapSize;     // от начала кучи до __brkval
+        uint16_t heapFree;     // в свободных блоках внутри кучи
+        uint16_t heapLargest;  // наибольший свободный блок
+        uint16_t stackNow;
+        uint16_t stackPeak;    // наибольшая глубина с запуска
+        uint16_t unused;       // ни разу не тронуто ни стеком, ни кучей
+    };
+
+    // Строка отчета о размере глобального объекта, имя в PROGMEM
+    struct ObjectSize
+    {
+        const char* name;
+        uint16_t size;
+    };
+
+private:
+    static uint16_t unused;
+    static bool warned;
+
+public:
+    // Очередной кусок поиска глубины стека, не больше SCAN_BYTES байт
+    static void update();
+
+    static bool getStats(Stats& out);
+    // Нетронутые байты по последнему законченному проходу, UINT16_MAX - неизвестно
+    static uint16_t getUnused() { return unused; }
+
+    static void dump(Print& out);
+    // Размеры глобальных объектов, таблица в PROGMEM собирается при компиляции через sizeof.
+    // На AVR дальше остаток .data/.bss/.noinit вне таблицы, куча и их сумма
+    static void dumpObjects(Print& out, const ObjectSize* table, uint8_t count);
+};
+
+#endif
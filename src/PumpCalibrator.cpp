@@ -0,0 +1,190 @@
+#include "PumpCalibrator.h"
+#include "RtcNvram.h"
+
+PumpCalibrator::PumpCalibrator(DeviceManager& devices, const Config& config) : devices(devices), config(config)
+{
+    for (uint8_t i = 0; i < BIN_COUNT; i++)
+    {
+        flow[i] = 0;
+    }
+    sampleSum = 0;
+    sampleCount = 0;
+    idleSince = 0;
+    lastRunMs = 0;
+    levelValid = false;
+    levelMl = 0;
+    inPulse = false;
+    pulseStartMl = 0;
+    pulseStartRunMs = 0;
+    sumBin = 0;
+    sumDropMl = 0;
+    sumRunMs = 0;
+}
+
+void PumpCalibrator::begin()
+{
+    load();
+    lastRunMs = devices.getPumpRunMs();
+    idleSince = millis();
+}
+
+uint8_t PumpCalibrator::binFor(uint32_t volumeMl) const
+{
+    if (config.tankCapacityMl == 0)
+        return 0;
+    uint32_t bin = volumeMl * BIN_COUNT / config.tankCapacityMl;
+    return bin < BIN_COUNT ? static_cast<uint8_t>(bin) : BIN_COUNT - 1;
+}
+
+uint16_t PumpCalibrator::getFlowRate(uint32_t volumeMl) const
+{
+    int8_t bin = static_cast<int8_t>(binFor(volumeMl));
+    for (int8_t d = 0; d < BIN_COUNT; d++)
+    {
+        if (bin - d >= 0 && flow[bin - d] != 0)
+            return flow[bin - d];
+        if (bin + d < BIN_COUNT && flow[bin + d] != 0)
+            return flow[bin + d];
+    }
+    return config.nominalMlPerMin;
+}
+
+void PumpCalibrator::update(Millilitres water, bool waterValid)
+{
+    uint32_t now = millis();
+    uint32_t runMs = devices.getPumpRunMs();
+    if (devices.isPumpOn() || runMs != lastRunMs)
+    {
+        startPulse(lastRunMs);
+        lastRunMs = runMs;
+        idleSince = now;
+        sampleSum = 0;
+        sampleCount = 0;
+        return;
+    }
+
+    if (!waterValid)
+    {
+        // Без уровня до и после порцию не измерить
+        inPulse = false;
+        levelValid = false;
+        sampleSum = 0;
+        sampleCount = 0;
+        return;
+    }
+
+    // Следующая порция пойдет с оценкой для нынешнего уровня
+    devices.setPumpFlowRate(getFlowRate(water.getRaw()));
+
+    if (now - idleSince < SETTLE_MS)
+        return;
+    sampleSum += water.getRaw();
+    if (++sampleCount < SAMPLE_COUNT)
+        return;
+
+    levelMl = (sampleSum + SAMPLE_COUNT / 2) / SAMPLE_COUNT;
+    levelValid = true;
+    sampleSum = 0;
+    sampleCount = 0;
+    if (inPulse)
+        finishPulse(levelMl, runMs);
+}
+
+void PumpCalibrator::startPulse(uint32_t runMs)
+{
+    // Насос включился: уровень перед ним - последний средний, он не старше
+    // двух окон усреднения. Если его нет (пауза короче окна), порцию
+    // присоединяем к предыдущей, иначе пропускаем
+    if (inPulse)
+        return;
+    if (!levelValid)
+        return;
+    inPulse = true;
+    pulseStartMl = levelMl;
+    pulseStartRunMs = runMs;
+    levelValid = false;
+}
+
+void PumpCalibrator::finishPulse(uint32_t volumeMl, uint32_t runMs)
+{
+    inPulse = false;
+    uint32_t pulseRunMs = runMs - pulseStartRunMs;
+    if (pulseRunMs == 0)
+        return;
+    int32_t drop = static_cast<int32_t>(pulseStartMl) - static_cast<int32_t>(volumeMl);
+    if (drop < -static_cast<int32_t>(config.refillMl))
+    {
+        // Долили во время порции - накопленное по старому уровню не годится
+        sumDropMl = 0;
+        sumRunMs = 0;
+        return;
+    }
+    measure(binFor((pulseStartMl + volumeMl) / 2), drop, pulseRunMs);
+}
+
+void PumpCalibrator::measure(uint8_t bin, int32_t dropMl, uint32_t runMs)
+{
+    if (bin != sumBin)
+    {
+        sumBin = bin;
+        sumDropMl = 0;
+        sumRunMs = 0;
+    }
+    // Убыль одной порции меньше шага уровня и может выйти отрицательной,
+    // в сумме по порциям ошибка округления усредняется
+    sumDropMl += dropMl;
+    sumRunMs += runMs;
+    if (sumDropMl < static_cast<int32_t>(config.minMeasureMl))
+        return;
+
+    uint32_t runDs = sumRunMs / 100;
+    uint32_t rate = runDs > 0 ? static_cast<uint32_t>(sumDropMl) * 600UL / runDs : UINT32_MAX;
+    sumDropMl = 0;
+    sumRunMs = 0;
+    if (rate < config.nominalMlPerMin / 4U || rate > config.nominalMlPerMin * 4UL)
+    {
+        LOG_WARN(DEVICES, EV_PUMP_FLOW_REJECTED, "Pump flow implausible, ml/min", rate);
+        return;
+    }
+    flow[bin] = flow[bin] == 0 ? static_cast<uint16_t>(rate)
+                               : static_cast<uint16_t>((flow[bin] * 3UL + rate + 2) / 4);
+    save();
+    LOG_INFO(DEVICES, EV_PUMP_FLOW, "Pump flow, ml/min", flow[bin]);
+}
+
+void PumpCalibrator::load()
+{
+    uint8_t data[NVRAM_SIZE];
+    if (!RtcNvram::read(RtcNvram::PUMP_FLOW_OFFSET, data, sizeof(data)))
+        return;
+
+    uint8_t check = 0;
+    for (uint8_t i = 0; i < NVRAM_SIZE - 1; i++)
+    {
+        check ^= data[i];
+    }
+    if (data[0] != NVRAM_MAGIC || check != data[NVRAM_SIZE - 1])
+        return;
+
+    for (uint8_t i = 0; i < BIN_COUNT; i++)
+    {
+        uint16_t rate = static_cast<uint16_t>(data[1 + i * 2] | (data[2 + i * 2] << 8));
+        if (rate == 0 || (rate >= config.nominalMlPerMin / 4U && rate <= config.nominalMlPerMin * 4UL))
+            flow[i] = rate;
+    }
+}
+
+void PumpCalibrator::save() const
+{
+    uint8_t data[NVRAM_SIZE];
+    data[0] = NVRAM_MAGIC;
+    uint8_t check = data[0];
+    for (uint8_t i = 0; i < BIN_COUNT; i++)
+    {
+        data[1 + i * 2] = static_cast<uint8_t>(flow[i]);
+        data[2 + i * 2] = static_cast<uint8_t>(flow[i] >> 8);
+        check ^= data[1 + i * 2] ^ data[2 + i * 2];
+    }
+    data[NVRAM_SIZE - 1] = check;
+    RtcNvram::write(RtcNvram::PUMP_FLOW_OFFSET, data, sizeof(data));
+}
@@ -0,0 +1,83 @@
+#ifndef PUMP_CALIBRATOR_H
+#define PUMP_CALIBRATOR_H
+
+#include <Arduino.h>
+#include "DeviceManager.h"
+#include "FixedPoint.h"
+#include "Log.h"
+
+// Подстройка производительности насоса по убыли воды в баке. Каждое включение
+// насоса мерится отдельно: уровень - среднее из SAMPLE_COUNT замеров - берется
+// последний перед включением и первый через SETTLE_MS после остановки. Окно
+// замера - десятки секунд, испарение и подтекание за него пренебрежимо малы.
+// Одного замера дальномера (1 мм - почти 0.8 л) на порцию не хватает, поэтому
+// убыль и время работы копятся по порциям, и оценка делается, когда из бака
+// ушло не меньше minMeasureMl: ошибка округления уровня у разных порций
+// случайна и при сложении усредняется. Напор зависит от уровня, оценки копятся
+// по диапазонам уровня (BIN_COUNT частей бака) и переживают сброс в NVRAM часов.
+// Перед каждым включением насоса DeviceManager получает оценку для текущего уровня.
+class PumpCalibrator
+{
+public:
+    static const uint8_t BIN_COUNT = 4;
+    static const uint8_t SAMPLE_COUNT = 16;
+    static const uint32_t SETTLE_MS = 5000;  // после остановки насоса вода успокаивается
+
+    struct Config
+    {
+        uint16_t nominalMlPerMin;  // пока нет оценки
+        uint32_t tankCapacityMl;   // полный бак, для диапазонов уровня
+        uint16_t minMeasureMl;     // убыль для одной оценки, сумма по порциям
+        uint16_t refillMl;         // рост уровня за порцию больше этого - долили, отсчет заново
+    };
+
+private:
+    static const uint8_t NVRAM_MAGIC = 0xF1;
+    static const uint8_t NVRAM_SIZE = 2 + BIN_COUNT * 2;
+
+    DeviceManager& devices;
+    Config config;
+
+    uint16_t flow[BIN_COUNT];  // мл/мин, 0 - в этом диапазоне еще не мерили
+
+    // Средний уровень, пока насос стоит
+    uint32_t sampleSum;
+    uint8_t sampleCount;
+    uint32_t idleSince;
+    uint32_t lastRunMs;
+    bool levelValid;  // последний средний уровень снят после последней работы насоса
+    uint32_t levelMl;
+
+    // Текущая порция: уровень перед включением и счетчик работы насоса на тот момент
+    bool inPulse;
+    uint32_t pulseStartMl;
+    uint32_t pulseStartRunMs;
+
+    // Сумма по порциям одного диапазона уровня
+    uint8_t sumBin;
+    int32_t sumDropMl;
+    uint32_t sumRunMs;
+
+    uint8_t binFor(uint32_t volumeMl) const;
+    void startPulse(uint32_t runMs);
+    void finishPulse(uint32_t volumeMl, uint32_t runMs);
+    void measure(uint8_t bin, int32_t dropMl, uint32_t runMs);
+    void load();
+    void save() const;
+
+public:
+    PumpCalibrator(DeviceManager& devices, const Config& config);
+
+    // Восстановить оценки из NVRAM часов, вызывать после I2cBus::begin()
+    void begin();
+
+    // Вызывать раз в секунду с текущим объемом в баке
+    void update(Millilitres water, bool waterValid);
+
+    // Оценка производительности при данном объеме в баке:
+    // свой диапазон, иначе ближайший измеренный, иначе паспортная
+    uint16_t getFlowRate(uint32_t volumeMl) const;
+    uint16_t getBinFlowRate(uint8_t bin) const { return bin < BIN_COUNT ? flow[bin] : 0; }
+};
+
+#endif
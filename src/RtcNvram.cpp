@@ -0,0 +1,41 @@
+#include "RtcNvram.h"
+
+bool RtcNvram::read(uint8_t offset, void* data, uint8_t len)
+{
+    if (offset >= SIZE || len > SIZE - offset)
+        return false;
+
+    uint8_t* out = static_cast<uint8_t*>(data);
+    while (len > 0)
+    {
+        uint8_t chunk = len < CHUNK_SIZE ? len : CHUNK_SIZE;
+
+        if (!I2cBus::readRegisters(I2cBus::DEV_DS1307, static_cast<uint8_t>(BASE_REGISTER + offset), out, chunk, false))
+            return false;
+
+        out += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool RtcNvram::write(uint8_t offset, const void* data, uint8_t len)
+{
+    if (offset >= SIZE || len > SIZE - offset)
+        return false;
+
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    while (len > 0)
+    {
+        uint8_t chunk = len < CHUNK_SIZE ? len : CHUNK_SIZE;
+
+        if (!I2cBus::write(I2cBus::DEV_DS1307, static_cast<uint8_t>(BASE_REGISTER + offset), in, chunk))
+            return false;
+
+        in += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return true;
+}
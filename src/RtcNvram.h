@@ -0,0 +1,30 @@
+#ifndef RTC_NVRAM_H
+#define RTC_NVRAM_H
+
+#include <Arduino.h>
+#include "I2cBus.h"
+
+// 56 байт ОЗУ DS1307 с питанием от батарейки: переживают сброс и отключение
+// питания, записи не изнашивают. Обмен кусками, чтобы влезать в буфер Wire.
+class RtcNvram
+{
+public:
+    static const uint8_t SIZE = 56;
+
+    // Раскладка
+    static const uint8_t CLOCK_DRIFT_OFFSET = 0;  // SoftClock: 4 байта
+    static const uint8_t PUMP_FLOW_OFFSET = 4;    // PumpCalibrator: 10 байт
+    static const uint8_t DLI_OFFSET = 14;         // DailyLight: 8 байт
+    static const uint8_t IRRIGATION_OFFSET = 22;  // Irrigation: 9 байт
+    static const uint8_t USER_OFFSET = 31;        // дальше свободно
+
+private:
+    static const uint8_t BASE_REGISTER = 0x08;
+    static const uint8_t CHUNK_SIZE = 16;
+
+public:
+    static bool read(uint8_t offset, void* data, uint8_t len);
+    static bool write(uint8_t offset, const void* data, uint8_t len);
+};
+
+#endif
@@ -0,0 +1,353 @@
+#include "RuleEngine.h"
+
+static const char inputAlways[] PROGMEM = "always";
+static const char inputTemp[] PROGMEM = "temp";
+static const char inputHum[] PROGMEM = "hum";
+static const char inputCo2[] PROGMEM = "co2";
+static const char inputLux[] PROGMEM = "lux";
+static const char inputSoil1[] PROGMEM = "soil1";
+static const char inputSoil2[] PROGMEM = "soil2";
+static const char inputWater[] PROGMEM = "water";
+static const char* const inputNames[] PROGMEM = {inputAlways, inputTemp,  inputHum,   inputCo2,
+                                                 inputLux,    inputSoil1, inputSoil2, inputWater};
+
+static const char actionNone[] PROGMEM = "&";
+static const char actionLight[] PROGMEM = "light";
+static const char actionFan[] PROGMEM = "fan";
+static const char actionPump[] PROGMEM = "pump";
+static const char actionAlert[] PROGMEM = "alert";
+static const char* const actionNames[] PROGMEM = {actionNone, actionLight, actionFan, actionPump, actionAlert};
+
+RuleEngine::RuleEngine()
+{
+    defaults = nullptr;
+    defaultCount = 0;
+    fromEeprom = false;
+    count = 0;
+    latched = 0;
+    fired = 0;
+    lastEvalUs = 0;
+    maxEvalUs = 0;
+
+    uploadState = UPLOAD_IDLE;
+    uploadCount = 0;
+    uploadCrc = 0;
+    expectedCrc = 0;
+    rulesReceived = 0;
+    received = 0;
+    lastByteTime = 0;
+
+    pendingAddress = 0;
+    pendingLength = 0;
+    pendingPos = 0;
+}
+
+uint8_t RuleEngine::begin(const uint8_t* defaultRules, uint8_t defaultRuleCount)
+{
+    defaults = defaultRules;
+    defaultCount = defaultRuleCount > RuleTable::MAX_RULES ? RuleTable::MAX_RULES : defaultRuleCount;
+    loadTable();
+    return count;
+}
+
+bool RuleEngine::loadTable()
+{
+    latched = 0;
+    fired = 0;
+
+    uint8_t header[RuleTable::HEADER_SIZE];
+    eeprom_read_block(header, eepromAddress(0), RuleTable::HEADER_SIZE);
+    bool valid = header[0] == RuleTable::MAGIC && header[1] == RuleTable::VERSION && header[2] > 0 &&
+                 header[2] <= RuleTable::MAX_RULES;
+    if (valid)
+    {
+        uint8_t crc = 0xFF;
+        uint16_t length = static_cast<uint16_t>(header[2]) * RuleTable::RULE_SIZE;
+        for (uint16_t i = 0; i < length; i++)
+        {
+            crc = RuleTable::crc8Update(crc, eeprom_read_byte(eepromAddress(RuleTable::HEADER_SIZE + i)));
+        }
+        valid = crc == header[3];
+    }
+
+    // Пустая или испорченная таблица в EEPROM - работаем по умолчанию
+    fromEeprom = valid;
+    count = valid ? header[2] : defaultCount;
+    return valid;
+}
+
+bool RuleEngine::readRule(uint8_t index, RuleTable::Rule& rule) const
+{
+    uint8_t record[RuleTable::RULE_SIZE];
+    uint16_t offset = static_cast<uint16_t>(index) * RuleTable::RULE_SIZE;
+    if (fromEeprom)
+    {
+        eeprom_read_block(record, eepromAddress(RuleTable::HEADER_SIZE + offset), RuleTable::RULE_SIZE);
+    }
+    else
+    {
+        memcpy_P(record, defaults + offset, RuleTable::RULE_SIZE);
+    }
+    return RuleTable::decode(record, rule);
+}
+
+bool RuleEngine::inWindow(const RuleTable::Rule& rule, uint8_t hour)
+{
+    if (rule.fromHour == rule.toHour)
+        return true;
+    if (rule.fromHour < rule.toHour)
+        return hour >= rule.fromHour && hour < rule.toHour;
+    return hour >= rule.fromHour || hour < rule.toHour;
+}
+
+bool RuleEngine::check(const RuleTable::Rule& rule, const Inputs& inputs, bool wasActive)
+{
+    if (rule.input == RuleTable::IN_ALWAYS)
+        return true;
+    if (!(inputs.validMask & (1 << rule.input)))
+        return false;
+
+    // Сработавшее условие отпускаем только за полосой гистерезиса
+    int32_t value = inputs.values[rule.input];
+    int32_t threshold = rule.threshold;
+    if (rule.op == RuleTable::OP_LESS)
+        return value < (wasActive ? threshold + rule.hysteresis : threshold);
+    return value > (wasActive ? threshold - rule.hysteresis : threshold);
+}
+
+void RuleEngine::evaluate(const Inputs& inputs, Outputs& outputs)
+{
+    uint32_t start = micros();
+
+    outputs.light = false;
+    outputs.fan = false;
+    outputs.pumpMl = 0;
+    outputs.alert = NO_ALERT;
+
+    bool chain = true;  // результат условий, связанных через AND с текущим
+    RuleTable::Rule rule;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint16_t bit = static_cast<uint16_t>(1U << i);
+        if (!readRule(i, rule))
+        {
+            chain = true;
+            continue;
+        }
+
+        bool active = inWindow(rule, inputs.hour) && check(rule, inputs, (latched & bit) != 0);
+        if (active)
+            latched |= bit;
+        else
+            latched &= ~bit;
+
+        active = active && chain;
+        if (rule.andNext)
+        {
+            chain = active;
+            continue;
+        }
+        chain = true;
+
+        switch (rule.action)
+        {
+        case RuleTable::ACT_LIGHT:
+            outputs.light = outputs.light || active;
+            break;
+        case RuleTable::ACT_FAN:
+            outputs.fan = outputs.fan || active;
+            break;
+        case RuleTable::ACT_PUMP:
+            if (active && !(fired & bit))
+                outputs.pumpMl = static_cast<uint16_t>(rule.arg) * 10U;
+            break;
+        case RuleTable::ACT_ALERT:
+            if (active && outputs.alert == NO_ALERT)
+                outputs.alert = rule.arg;
+            break;
+        default:
+            break;
+        }
+
+        if (active)
+            fired |= bit;
+        else
+            fired &= ~bit;
+    }
+
+    uint32_t elapsed = micros() - start;
+    lastEvalUs = elapsed > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(elapsed);
+    if (lastEvalUs > maxEvalUs)
+        maxEvalUs = lastEvalUs;
+}
+
+void RuleEngine::startUpload()
+{
+    // На время приема действуют правила по умолчанию
+    fromEeprom = false;
+    count = defaultCount;
+    latched = 0;
+    fired = 0;
+
+    uploadState = UPLOAD_HEADER;
+    received = 0;
+    rulesReceived = 0;
+    uploadCrc = 0xFF;
+    pendingLength = 0;
+    pendingPos = 0;
+    lastByteTime = millis();
+}
+
+void RuleEngine::receive(HardwareSerial& serial)
+{
+    if (uploadState == UPLOAD_IDLE)
+        return;
+
+    // Новый байт берем, только когда предыдущая порция ушла в EEPROM
+    while (pendingPos >= pendingLength && serial.available() > 0 &&
+           (uploadState == UPLOAD_HEADER || uploadState == UPLOAD_RULES))
+    {
+        uint8_t data = static_cast<uint8_t>(serial.read());
+        lastByteTime = millis();
+        pending[received++] = data;
+
+        if (uploadState == UPLOAD_HEADER)
+        {
+            if (received < RuleTable::HEADER_SIZE)
+                continue;
+
+            if (pending[0] != RuleTable::MAGIC || pending[1] != RuleTable::VERSION ||
+                pending[2] > RuleTable::MAX_RULES)
+            {
+                finishUpload(false);
+                return;
+            }
+            uploadCount = pending[2];
+            expectedCrc = pending[3];
+            // magic запишется последним, до этого таблица в EEPROM недействительна
+            pending[0] = 0xFF;
+            startWrite(0, RuleTable::HEADER_SIZE);
+            uploadState = uploadCount > 0 ? UPLOAD_RULES : UPLOAD_CRC_CHECK;
+        }
+        else
+        {
+            uploadCrc = RuleTable::crc8Update(uploadCrc, data);
+            if (received < RuleTable::RULE_SIZE)
+                continue;
+
+            startWrite(RuleTable::HEADER_SIZE + static_cast<uint16_t>(rulesReceived) * RuleTable::RULE_SIZE,
+                       RuleTable::RULE_SIZE);
+            if (++rulesReceived >= uploadCount)
+                uploadState = UPLOAD_CRC_CHECK;
+        }
+    }
+
+    if ((uploadState == UPLOAD_HEADER || uploadState == UPLOAD_RULES) && millis() - lastByteTime > UPLOAD_TIMEOUT_MS)
+    {
+        finishUpload(false);
+    }
+}
+
+void RuleEngine::startWrite(uint16_t offset, uint8_t length)
+{
+    pendingAddress = offset;
+    pendingLength = length;
+    pendingPos = 0;
+    received = 0;
+}
+
+void RuleEngine::update()
+{
+    while (pendingPos < pendingLength && eeprom_is_ready())
+    {
+        eeprom_update_byte(eepromAddress(pendingAddress + pendingPos), pending[pendingPos]);
+        pendingPos++;
+    }
+    if (pendingPos < pendingLength)
+        return;
+
+    if (uploadState == UPLOAD_CRC_CHECK)
+    {
+        if (uploadCrc != expectedCrc)
+        {
+            finishUpload(false);
+            return;
+        }
+        pending[0] = RuleTable::MAGIC;
+        startWrite(0, 1);
+        uploadState = UPLOAD_COMMIT;
+    }
+    else if (uploadState == UPLOAD_COMMIT)
+    {
+        finishUpload(true);
+    }
+}
+
+void RuleEngine::finishUpload(bool accepted)
+{
+    uploadState = UPLOAD_IDLE;
+    pendingLength = 0;
+    pendingPos = 0;
+    received = 0;
+
+    loadTable();
+    if (accepted)
+    {
+        LOG_INFO(MAIN, EV_RULES_OK, "Rules loaded", count);
+    }
+    else
+    {
+        LOG_WARN(MAIN, EV_RULES_REJECTED, "Rules upload rejected", rulesReceived);
+    }
+}
+
+void RuleEngine::dump(Print& out) const
+{
+    out.print(F("rules: "));
+    out.print(count);
+    out.print(fromEeprom ? F(" eeprom") : F(" default"));
+    out.print(F(", eval "));
+    out.print(lastEvalUs);
+    out.print(F(" us, max "));
+    out.print(maxEvalUs);
+    out.println(F(" us"));
+
+    RuleTable::Rule rule;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        out.print(i);
+        out.write(' ');
+        if (!readRule(i, rule))
+        {
+            out.println(F("?"));
+            continue;
+        }
+        out.print(reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&inputNames[rule.input])));
+        if (rule.input != RuleTable::IN_ALWAYS)
+        {
+            out.write(rule.op == RuleTable::OP_LESS ? '<' : '>');
+            out.print(rule.threshold);
+            if (rule.hysteresis != 0)
+            {
+                out.print(F(" hyst "));
+                out.print(rule.hysteresis);
+            }
+        }
+        if (rule.fromHour != rule.toHour)
+        {
+            out.print(F(" at "));
+            out.print(rule.fromHour);
+            out.write('-');
+            out.print(rule.toHour);
+        }
+        out.write(' ');
+        out.print(reinterpret_cast<const __FlashStringHelper*>(
+            pgm_read_ptr(&actionNames[rule.andNext ? RuleTable::ACT_NONE : rule.action])));
+        if (!rule.andNext && (rule.action == RuleTable::ACT_PUMP || rule.action == RuleTable::ACT_ALERT))
+        {
+            out.write(' ');
+            out.print(rule.action == RuleTable::ACT_PUMP ? rule.arg * 10U : rule.arg);
+        }
+        out.println();
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include "RuleTable.h"
+#include "Log.h"
+
+// Интерпретатор таблицы правил (формат - RuleTable.h). Правила читаются прямо
+// из EEPROM или, если там нет целой таблицы, из таблицы по умолчанию в PROGMEM;
+// в ОЗУ только по два бита состояния на правило. Проход по таблице ограничен
+// MAX_RULES правилами, время последнего и худшего прохода хранится.
+// Новая таблица принимается по Serial и пишется в EEPROM в фоне, по байту.
+class RuleEngine
+{
+public:
+    // Начало области настроек EEPROM (нижние 768 байт - журнал EepromLog)
+    static const uint16_t TABLE_ADDRESS = 768;
+    static const uint16_t UPLOAD_TIMEOUT_MS = 2000;
+    static const uint8_t NO_ALERT = 0xFF;
+
+    // Значения входов в единицах RuleTable::Input
+    struct Inputs
+    {
+        int16_t values[RuleTable::INPUT_COUNT];
+        uint8_t validMask;  // бит на вход, недействительный вход не выполняет условие
+        uint8_t hour;
+    };
+
+    struct Outputs
+    {
+        bool light;
+        bool fan;
+        uint16_t pumpMl;  // 0 - насос не запускать
+        uint8_t alert;    // номер сообщения или NO_ALERT
+    };
+
+private:
+    enum UploadState : uint8_t
+    {
+        UPLOAD_IDLE,
+        UPLOAD_HEADER,
+        UPLOAD_RULES,
+        UPLOAD_CRC_CHECK,
+        UPLOAD_COMMIT
+    };
+
+    const uint8_t* defaults;  // PROGMEM
+    uint8_t defaultCount;
+    bool fromEeprom;
+    uint8_t count;
+
+    uint16_t latched;  // условие выполнено (для гистерезиса)
+    uint16_t fired;    // действие уже сработало (фронт для насоса)
+    uint16_t lastEvalUs;
+    uint16_t maxEvalUs;
+
+    // Прием новой таблицы
+    UploadState uploadState;
+    uint8_t uploadCount;
+    uint8_t uploadCrc;
+    uint8_t expectedCrc;
+    uint8_t rulesReceived;
+    uint8_t received;  // байт в pending
+    uint32_t lastByteTime;
+
+    // Фоновая запись в EEPROM
+    uint8_t pending[RuleTable::RULE_SIZE];
+    uint16_t pendingAddress;
+    uint8_t pendingLength;
+    uint8_t pendingPos;
+
+    static uint8_t* eepromAddress(uint16_t offset) { return reinterpret_cast<uint8_t*>(TABLE_ADDRESS + offset); }
+    static bool inWindow(const RuleTable::Rule& rule, uint8_t hour);
+    static bool check(const RuleTable::Rule& rule, const Inputs& inputs, bool wasActive);
+
+    bool readRule(uint8_t index, RuleTable::Rule& rule) const;
+    bool loadTable();
+    void startWrite(uint16_t offset, uint8_t length);
+    void finishUpload(bool accepted);
+
+public:
+    RuleEngine();
+
+    // defaults - таблица правил в PROGMEM. Возвращает число действующих правил
+    uint8_t begin(const uint8_t* defaults, uint8_t defaultCount);
+
+    void evaluate(const Inputs& inputs, Outputs& outputs);
+
+    // Фоновая запись принятой таблицы, вызывать часто
+    void update();
+
+    // Прием таблицы: после startUpload() байты забирает receive(), пока isReceiving()
+    void startUpload();
+    void receive(HardwareSerial& serial);
+    bool isReceiving() const { return uploadState != UPLOAD_IDLE; }
+
+    uint8_t getRuleCount() const { return count; }
+    bool isFromEeprom() const { return fromEeprom; }
+    uint16_t getLastEvalUs() const { return lastEvalUs; }
+    uint16_t getMaxEvalUs() const { return maxEvalUs; }
+
+    void dump(Print& out) const;
+};
+
+#endif
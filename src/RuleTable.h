@@ -0,0 +1,131 @@
+#ifndef RULE_TABLE_H
+#define RULE_TABLE_H
+
+#include <stdint.h>
+
+// Упакованная таблица правил автоматики. Общая для прошивки и компилятора
+// правил на хосте (tools/rule_compile.cpp), поэтому без зависимостей от Arduino.
+//
+// Таблица: | magic | version | count | crc8 | rule[count] |, crc8 - по правилам.
+// Правило, RULE_SIZE байт:
+//   0    input (биты 0-3), op (биты 4-5), AND со следующим правилом (бит 6)
+//   1-2  порог, int16 LE, в единицах входа (0.1 °C, 0.1 %, ppm, 10 лк, %, 100 мл).
+//        Свет и вода в крупных единицах, чтобы в int16 влезали дневной свет и полный бак
+//   3-4  гистерезис, uint16 LE: условие держится, пока не отойдет от порога на столько
+//   5-6  окно по часам [from, to), from == to - круглые сутки; может переходить через полночь
+//   7    действие
+//   8    аргумент действия (насос - десятки мл, сообщение - номер)
+//
+// Устройство включено, пока выполняется хотя бы одно его правило.
+// Насос запускается по фронту условия, сообщение показывается, пока условие держится.
+
+class RuleTable
+{
+public:
+    static const uint8_t MAGIC = 0x52;  // 'R'
+    static const uint8_t VERSION = 2;  // 2: свет в 10 лк, вода в 100 мл
+    static const uint8_t HEADER_SIZE = 4;
+    static const uint8_t RULE_SIZE = 9;
+    static const uint8_t MAX_RULES = 16;
+
+    // Загрузка по Serial: команда 'u', затем таблица побайтно с паузой не меньше
+    // UPLOAD_BYTE_GAP_MS (EEPROM пишется в фоне). Пустая таблица - вернуть правила по умолчанию
+    static const uint8_t UPLOAD_COMMAND = 'u';
+    static const uint8_t UPLOAD_BYTE_GAP_MS = 40;
+
+    enum Input : uint8_t
+    {
+        IN_ALWAYS,       // всегда истинно, для правил только по времени
+        IN_TEMPERATURE,  // 0.1 °C
+        IN_HUMIDITY,     // 0.1 %
+        IN_CO2,          // ppm, выше 32767 (предел ENS160 - 65000) входит как 32767
+        IN_LIGHT,        // 10 лк
+        IN_SOIL_1,       // %
+        IN_SOIL_2,       // %
+        IN_WATER,        // 100 мл
+        INPUT_COUNT
+    };
+
+    enum Op : uint8_t
+    {
+        OP_LESS,
+        OP_GREATER
+    };
+
+    enum Action : uint8_t
+    {
+        ACT_NONE,
+        ACT_LIGHT,
+        ACT_FAN,    // полная скорость поверх регулятора
+        ACT_PUMP,   // запрос полива, исполняет Irrigation (порциями, с лимитами)
+        ACT_ALERT,
+        ACTION_COUNT
+    };
+
+    static const uint8_t FLAG_AND_NEXT = 0x40;
+    static const uint8_t LUX_PER_UNIT = 10;
+    static const uint8_t ML_PER_UNIT = 100;
+
+    struct Rule
+    {
+        Input input;
+        Op op;
+        bool andNext;
+        int16_t threshold;
+        uint16_t hysteresis;
+        uint8_t fromHour;
+        uint8_t toHour;
+        Action action;
+        uint8_t arg;
+    };
+
+    static uint8_t crc8Update(uint8_t crc, uint8_t data)
+    {
+        // Полином 0x31, начальное 0xFF - как у записей журнала в EEPROM
+        crc ^= data;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+        }
+        return crc;
+    }
+
+    // out должен вмещать RULE_SIZE байт
+    static void encode(const Rule& rule, uint8_t* out)
+    {
+        out[0] = static_cast<uint8_t>((rule.input & 0x0F) | ((rule.op & 0x03) << 4) | (rule.andNext ? FLAG_AND_NEXT : 0));
+        out[1] = static_cast<uint8_t>(rule.threshold);
+        out[2] = static_cast<uint8_t>(static_cast<uint16_t>(rule.threshold) >> 8);
+        out[3] = static_cast<uint8_t>(rule.hysteresis);
+        out[4] = static_cast<uint8_t>(rule.hysteresis >> 8);
+        out[5] = rule.fromHour;
+        out[6] = rule.toHour;
+        out[7] = rule.action;
+        out[8] = rule.arg;
+    }
+
+    // false, если в правиле неизвестный вход, действие или час
+    static bool decode(const uint8_t* in, Rule& rule)
+    {
+        rule.input = static_cast<Input>(in[0] & 0x0F);
+        rule.op = static_cast<Op>((in[0] >> 4) & 0x03);
+        rule.andNext = (in[0] & FLAG_AND_NEXT) != 0;
+        rule.threshold = static_cast<int16_t>(in[1] | (in[2] << 8));
+        rule.hysteresis = static_cast<uint16_t>(in[3] | (in[4] << 8));
+        rule.fromHour = in[5];
+        rule.toHour = in[6];
+        rule.action = static_cast<Action>(in[7]);
+        rule.arg = in[8];
+        return rule.input < INPUT_COUNT && rule.op <= OP_GREATER && rule.action < ACTION_COUNT && rule.fromHour < 24 &&
+               rule.toHour < 24;
+    }
+};
+
+// Правило для таблицы в PROGMEM: те же RULE_SIZE байт, что дает encode()
+#define RULE_BYTES(input, op, andNext, threshold, hysteresis, fromHour, toHour, action, arg)                          \
+    static_cast<uint8_t>((input) | ((op) << 4) | ((andNext) ? RuleTable::FLAG_AND_NEXT : 0)),                          \
+        static_cast<uint8_t>((threshold) & 0xFF), static_cast<uint8_t>(((threshold) >> 8) & 0xFF),                      \
+        static_cast<uint8_t>((hysteresis) & 0xFF), static_cast<uint8_t>(((hysteresis) >> 8) & 0xFF), (fromHour),       \
+        (toHour), (action), (arg)
+
+#endif
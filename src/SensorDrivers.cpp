@@ -0,0 +1,211 @@
+#include "SensorDrivers.h"
+
+bool LightSensor::begin()
+{
+    bool found = false;
+    if (I2cBus::select(I2cBus::DEV_VEML7700))
+    {
+        found = veml.begin();
+        I2cBus::wireRestarted();
+        if (found)
+        {
+            // Фиксируем усиление и время интегрирования, от них зависит RESOLUTION_X10000
+            veml.setGain(VEML7700_GAIN_1_8);
+            // Первый замер заберем через период датчиков, ждать интегрирования здесь незачем
+            veml.setIntegrationTime(VEML7700_IT_100MS, false);
+            veml.setLowThreshold(LOW_THRESHOLD);
+            veml.setHighThreshold(HIGH_THRESHOLD);
+            veml.interruptEnable(false);
+        }
+        found = I2cBus::finish(I2cBus::DEV_VEML7700, found);
+    }
+    if (!found)
+    {
+        LOG_ERROR(SENSORS, EV_VEML7700_FAIL, "VEML7700 FAIL");
+        return false;
+    }
+    LOG_INFO(SENSORS, EV_VEML7700_OK, "VEML7700 OK");
+    return true;
+}
+
+void LightSensor::read(SensorHealth& health)
+{
+    // Регистр ALS читаем сами: readALS() библиотеки не сообщает об ошибке обмена,
+    // и отсутствие датчика неотличимо от темноты
+    uint8_t data[2];
+    if (!I2cBus::readRegisters(I2cBus::DEV_VEML7700, VEML7700_ALS_DATA, data, sizeof(data), true))
+    {
+        health.fail(HEALTH_ID, SensorHealth::FAULT_READ);
+        return;
+    }
+    uint32_t als = data[0] | (static_cast<uint16_t>(data[1]) << 8);
+    // Сырые отсчеты ALS переводим в люксы целочисленно, без readLux() на float
+    uint32_t value = (als * RESOLUTION_X10000 + 5000UL) / 10000UL;
+    if (health.good(HEALTH_ID, value))
+        lux = Lux::fromRaw(value);
+}
+
+bool AirSensor::begin()
+{
+    // Первый замер запускаем сразу, результат заберем на следующем цикле
+    if (aht20.begin() && aht20.trigger())
+    {
+        LOG_INFO(SENSORS, EV_AHT20_OK, "AHT20 OK");
+        return true;
+    }
+    LOG_ERROR(SENSORS, EV_AHT20_FAIL, "AHT20 FAIL");
+    return false;
+}
+
+void AirSensor::read(SensorHealth& health)
+{
+    // Забираем замер, запущенный на прошлом цикле, и сразу запускаем следующий
+    AHT20Async::State state = aht20.poll();
+    if (state == AHT20Async::STATE_READY)
+    {
+        if (health.good(HEALTH_ID, aht20.getTemperature().getRaw()))
+        {
+            temperature = aht20.getTemperature();
+            humidity = aht20.getHumidity();
+        }
+    }
+    else if (state == AHT20Async::STATE_ERROR)
+    {
+        LOG_WARN(SENSORS, EV_AHT20_ERROR, "AHT20 read error");
+        health.fail(HEALTH_ID, SensorHealth::FAULT_READ);
+    }
+
+    if (!aht20.isBusy())
+        aht20.trigger();
+}
+
+bool AirQualitySensor::begin()
+{
+    bool found = false;
+    if (I2cBus::select(I2cBus::DEV_ENS160))
+    {
+        ens160.begin();
+        I2cBus::wireRestarted();
+        // available() выставляется в begin() по ID чипа, ждать здесь нечего
+        ens160.setMode(ENS160_OPMODE_STD);
+        found = I2cBus::finish(I2cBus::DEV_ENS160, ens160.available());
+    }
+    if (!found)
+    {
+        LOG_ERROR(SENSORS, EV_ENS160_FAIL, "ens160 FAIL");
+        return false;
+    }
+    LOG_INFO(SENSORS, EV_ENS160_OK, "ens160 OK");
+    return true;
+}
+
+void AirQualitySensor::read(SensorHealth& health)
+{
+    // Один байт статуса на тик, данные читаются только при NEWDAT.
+    // Ошибки обмена видны как отсутствие новых замеров (stale)
+    if (data.poll() && health.good(HEALTH_ID, data.getECO2()))
+    {
+        eco2 = Ppm::fromRaw(data.getECO2());
+        tvoc = data.getTVOC();
+        aqi = data.getAQI();
+        sampleTime = data.getSampleTime();
+    }
+}
+
+uint8_t SoilCalibration::toPercent(uint16_t filtered)
+{
+    // Калибровка задана в отсчетах analogRead(), результат АЦП в RESULT_SCALE раз точнее
+    long percentage = map(filtered, DRY_VALUE * AdcSampler::RESULT_SCALE,
+                          WET_VALUE * AdcSampler::RESULT_SCALE, 0, 100);
+    return constrain(percentage, 0, 100);
+}
+
+bool SoilChannel::begin(uint8_t pin)
+{
+    // Канал добавляется один раз; повторная инициализация лишь снова берет замеры,
+    // и если они опять вне диапазона, датчик отключится с удвоенной паузой
+    if (channel >= 0)
+        return true;
+
+    pinMode(pin, INPUT);
+    channel = adc.addChannel(pin);
+    // Перезапуск АЦП с уже добавленными каналами; analogRead() дальше не вызываем
+    adc.begin();
+    LOG_INFO(SENSORS, EV_SOIL_OK, "Soil sensor OK, pin", pin);
+    return channel >= 0;
+}
+
+void SoilChannel::read(SensorHealth& health, SensorHealth::Sensor id)
+{
+    // Обрыв и замыкание видны только по выходу за диапазон
+    if (!adc.hasResult())
+        return;
+    uint16_t value = adc.getValue(channel);
+    if (health.good(id, value))
+        moisture = SoilCalibration::toPercent(value);
+}
+
+bool WaterSensor::begin()
+{
+    // Эхо приходит по прерыванию, первый замер появится через несколько вызовов poll()
+    hc.begin();
+    LOG_INFO(SENSORS, EV_HCSR04_OK, "HC-SR04 OK");
+    echoCount = hc.getEchoCount();
+    return true;
+}
+
+void WaterSensor::read(SensorHealth& health)
+{
+    // Только новые эхо; без них датчик отключится по stale
+    uint16_t echoes = hc.getEchoCount();
+    if (echoes == echoCount)
+        return;
+    echoCount = echoes;
+
+    uint16_t mm = hc.getDistanceMm();
+    if (health.good(HEALTH_ID, mm))
+    {
+        distance = Millimetres::fromRaw(mm);
+        volume = volumeAt(distance);
+    }
+}
+
+Millilitres WaterSensor::volumeAt(Millimetres toBottom)
+{
+    const uint16_t tankHeightMm = TANK_HEIGHT_CM * 10U;
+
+    uint16_t waterHeightMm = 0;
+    if (toBottom.getRaw() < tankHeightMm)
+        waterHeightMm = tankHeightMm - toBottom.getRaw();
+
+    // мм^2 * мм = мм^3, 1000 мм^3 = 1 мл
+    return Millilitres::fromRaw((TANK_AREA_MM2 * waterHeightMm + 500UL) / 1000UL);
+}
+
+bool ClockSensor::begin()
+{
+    // Если RTC не ответил, часы сами повторят синхронизацию позже
+    if (!clock.begin())
+    {
+        LOG_ERROR(SENSORS, EV_RTC_FAIL, "RTC FAIL");
+        return false;
+    }
+    LOG_INFO(SENSORS, EV_RTC_OK, "RTC OK");
+    return true;
+}
+
+void ClockSensor::read(SensorHealth&)
+{
+    // Время берется из программных часов, по I2C ходит только синхронизация
+    if (!clock.isValid())
+        return;
+
+    tmElements_t tm;
+    breakTime(clock.now(), tm);
+    second = tm.Second;
+    minute = tm.Minute;
+    hour = tm.Hour;
+    day = tm.Day;
+    month = tm.Month;
+    year = tmYearToCalendar(tm.Year);
+}
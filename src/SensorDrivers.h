@@ -0,0 +1,180 @@
+#ifndef SENSOR_DRIVERS_H
+#define SENSOR_DRIVERS_H
+
+#include <Arduino.h>
+#include "I2cBus.h"
+#include "Adafruit_VEML7700.h"
+#include "AHT20Async.h"
+#include "DS1307RTC.h"
+#include "ScioSense_ENS160.h"
+#include "ENS160Async.h"
+#include "UltrasonicAsync.h"
+#include "AdcSampler.h"
+#include "SoftClock.h"
+#include "FixedPoint.h"
+#include "SensorRegistry.h"
+#include "Log.h"
+
+// Датчики теплицы для SensorList (см. SensorRegistry.h): каждый сам
+// инициализируется, читается и хранит свои значения. Все опрашиваются на
+// каждом update_all(), то есть с периодом SENSORS_PERIOD_MS.
+
+// VEML7700: освещенность
+class LightSensor : public SensorDriver<LightSensor, SensorHealth::LIGHT>
+{
+private:
+    static const uint16_t LOW_THRESHOLD = 10000U;
+    static const uint16_t HIGH_THRESHOLD = 10000U;
+    // Люкс на отсчет при GAIN 1/8 и IT 100 мс, x10000
+    static const uint32_t RESOLUTION_X10000 = 4608UL;
+
+    Adafruit_VEML7700 veml;
+    Lux lux;
+
+public:
+    bool begin();
+    void read(SensorHealth& health);
+
+    Lux getLux() const { return lux; }
+};
+
+// AHT20: температура и влажность одного замера
+class AirSensor : public SensorDriver<AirSensor, SensorHealth::AIR_TEMP>
+{
+private:
+    AHT20Async aht20;
+    DeciCelsius temperature;
+    DeciPercent humidity;
+
+public:
+    bool begin();
+    void read(SensorHealth& health);
+
+    DeciCelsius getTemperature() const { return temperature; }
+    DeciPercent getHumidity() const { return humidity; }
+};
+
+// ENS160: eCO2, TVOC, AQI
+class AirQualitySensor : public SensorDriver<AirQualitySensor, SensorHealth::AIR_QUAL>
+{
+private:
+    ScioSense_ENS160 ens160;
+    ENS160Async data;
+    Ppm eco2;
+    uint16_t tvoc = 0;
+    uint8_t aqi = 0;
+    uint32_t sampleTime = 0;
+
+public:
+    AirQualitySensor() : ens160(ENS160_I2CADDR_1) {}
+
+    bool begin();
+    void read(SensorHealth& health);
+
+    Ppm getECO2() const { return eco2; }
+    uint16_t getTVOC() const { return tvoc; }
+    uint8_t getAQI() const { return aqi; }
+    uint32_t getSampleTime() const { return sampleTime; }
+};
+
+// Калибровка емкостных датчиков влажности почвы
+class SoilCalibration
+{
+public:
+    static const uint16_t DRY_VALUE = 470U;
+    static const uint16_t WET_VALUE = 200U;
+    // Отсчеты analogRead() у оборванного и замкнутого датчика
+    static const uint16_t OPEN_VALUE = 1000U;
+    static const uint16_t SHORT_VALUE = 50U;
+
+    static uint8_t toPercent(uint16_t filtered);
+};
+
+// Общий для всех SoilProbe код, чтобы не повторялся в каждом экземпляре шаблона
+class SoilChannel
+{
+private:
+    AdcSampler adc;  // состояние у AdcSampler общее
+    int8_t channel = -1;
+    uint8_t moisture = 0;
+
+public:
+    bool begin(uint8_t pin);
+    void read(SensorHealth& health, SensorHealth::Sensor id);
+
+    uint8_t getMoisture() const { return moisture; }
+};
+
+// Датчик влажности почвы на входе PIN, опрос фоном через AdcSampler
+template <SensorHealth::Sensor ID, uint8_t PIN>
+class SoilProbe : public SensorDriver<SoilProbe<ID, PIN>, ID>
+{
+private:
+    SoilChannel probe;
+
+public:
+    bool begin() { return probe.begin(PIN); }
+    void read(SensorHealth& health) { probe.read(health, ID); }
+
+    uint8_t getMoisture() const { return probe.getMoisture(); }
+};
+
+// HC-SR04 над баком: уровень и объем воды
+class WaterSensor : public SensorDriver<WaterSensor, SensorHealth::WATER>
+{
+public:
+    static const uint16_t TANK_DIAMETER_CM = 100U;
+    static const uint16_t TANK_HEIGHT_CM = 30U;
+
+private:
+    static const uint8_t TRIG_PIN = 11;
+    static const uint8_t ECHO_PIN = 12;
+    // Площадь дна в мм^2, pi ~ 355/113
+    static const uint32_t TANK_AREA_MM2 =
+        (TANK_DIAMETER_CM * 10UL) * (TANK_DIAMETER_CM * 10UL) * 355UL / (4UL * 113UL);
+
+    UltrasonicAsync hc;
+    uint16_t echoCount = 0;
+    Millimetres distance;
+    Millilitres volume;
+
+public:
+    WaterSensor() : hc(TRIG_PIN, ECHO_PIN) {}
+
+    bool begin();
+    void poll() { hc.update(); }
+    void read(SensorHealth& health);
+
+    Millimetres getDistance() const { return distance; }
+    Millilitres getVolume() const { return volume; }
+
+    static Millilitres volumeAt(Millimetres toBottom);
+    static Millilitres capacity() { return volumeAt(Millimetres::fromRaw(0)); }
+};
+
+// Программные часы с синхронизацией от DS1307. Связь с RTC часы
+// восстанавливают сами, поэтому без надзора SensorHealth
+class ClockSensor : public SensorDriver<ClockSensor, NO_HEALTH>
+{
+private:
+    SoftClock clock;
+    uint8_t hour = 0, minute = 0, second = 0;
+    uint8_t day = 0, month = 0;
+    uint16_t year = 0;
+
+public:
+    bool begin();
+    void poll() { clock.update(); }
+    void read(SensorHealth& health);
+
+    bool isValid() const { return clock.isValid(); }
+    uint8_t getHour() const { return hour; }
+    uint8_t getMinute() const { return minute; }
+    uint8_t getSecond() const { return second; }
+    uint8_t getDay() const { return day; }
+    uint8_t getMonth() const { return month; }
+    uint16_t getYear() const { return year; }
+    const SoftClock& getClock() const { return clock; }
+};
+
+#endif
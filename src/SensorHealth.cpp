@@ -0,0 +1,205 @@
+#include "SensorHealth.h"
+
+static const char nameLight[] PROGMEM = "light";
+static const char nameAir[] PROGMEM = "air";
+static const char nameCo2[] PROGMEM = "co2";
+static const char nameSoil1[] PROGMEM = "soil1";
+static const char nameSoil2[] PROGMEM = "soil2";
+static const char nameWater[] PROGMEM = "water";
+static const char* const sensorNames[] PROGMEM = {nameLight, nameAir, nameCo2, nameSoil1, nameSoil2, nameWater};
+
+static const char faultNone[] PROGMEM = "-";
+static const char faultInit[] PROGMEM = "init";
+static const char faultRead[] PROGMEM = "read";
+static const char faultRange[] PROGMEM = "range";
+static const char faultStuck[] PROGMEM = "stuck";
+static const char faultStale[] PROGMEM = "stale";
+static const char* const faultNames[] PROGMEM = {faultNone, faultInit, faultRead, faultRange, faultStuck, faultStale};
+
+SensorHealth::SensorHealth(const Limits* limits) : limits(limits)
+{
+    memset(states, 0, sizeof(states));
+}
+
+void SensorHealth::getLimits(Sensor sensor, Limits& out) const
+{
+    memcpy_P(&out, &limits[sensor], sizeof(Limits));
+}
+
+void SensorHealth::begin(Sensor sensor, bool ok)
+{
+    State& s = states[sensor];
+    uint32_t now = millis();
+    s.ok = ok;
+    s.failures = 0;
+    s.lastGood = now;
+    s.changedAt = now;
+    if (ok)
+    {
+        s.since = now;
+        s.fault = FAULT_NONE;
+        s.backoff = 0;
+    }
+    else
+    {
+        // Отказ уже в журнале от init_*, здесь только расписание повторов
+        s.since = now + RETRY_MIN_MS;
+        s.fault = FAULT_INIT;
+        s.backoff = 1;
+    }
+}
+
+bool SensorHealth::good(Sensor sensor, int32_t value)
+{
+    State& s = states[sensor];
+    if (!s.ok)
+        return false;
+
+    Limits l;
+    getLimits(sensor, l);
+    if (value < l.min || value > l.max)
+    {
+        fail(sensor, FAULT_RANGE);
+        return false;
+    }
+
+    uint32_t now = millis();
+    if (value != s.value)
+    {
+        s.value = value;
+        s.changedAt = now;
+    }
+    else if (l.stuckMin != 0 && now - s.changedAt >= l.stuckMin * 60000UL)
+    {
+        lose(sensor, FAULT_STUCK, now);
+        return false;
+    }
+
+    s.failures = 0;
+    s.lastGood = now;
+    // Проработал долго - следующий отказ снова с короткой паузы
+    if (s.backoff != 0 && now - s.since >= RETRY_MAX_MS)
+    {
+        s.backoff = 0;
+    }
+    return true;
+}
+
+void SensorHealth::fail(Sensor sensor, Fault fault)
+{
+    State& s = states[sensor];
+    if (!s.ok)
+        return;
+
+    s.fault = fault;
+    if (++s.failures >= FAIL_LIMIT)
+    {
+        lose(sensor, fault, millis());
+    }
+}
+
+void SensorHealth::checkStale()
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        State& s = states[i];
+        uint16_t staleMs = pgm_read_word(&limits[i].staleMs);
+        if (s.ok && staleMs != 0 && now - s.lastGood > staleMs)
+        {
+            lose(static_cast<Sensor>(i), FAULT_STALE, now);
+        }
+    }
+}
+
+void SensorHealth::scheduleRetry(State& s, uint32_t now)
+{
+    uint32_t delay = RETRY_MIN_MS << s.backoff;
+    s.since = now + (delay < RETRY_MAX_MS ? delay : RETRY_MAX_MS);
+    if (s.backoff < MAX_BACKOFF)
+        s.backoff++;
+}
+
+void SensorHealth::lose(Sensor sensor, Fault fault, uint32_t now)
+{
+    State& s = states[sensor];
+    s.ok = false;
+    s.fault = fault;
+    s.failures = 0;
+    scheduleRetry(s, now);
+    LOG_WARN(SENSORS, EV_SENSOR_LOST, "Sensor lost", sensor);
+}
+
+SensorHealth::Sensor SensorHealth::nextRetry() const
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        const State& s = states[i];
+        if (!s.ok && static_cast<int32_t>(now - s.since) >= 0)
+            return static_cast<Sensor>(i);
+    }
+    return SENSOR_COUNT;
+}
+
+void SensorHealth::retried(Sensor sensor, bool ok)
+{
+    State& s = states[sensor];
+    uint32_t now = millis();
+    if (!ok)
+    {
+        scheduleRetry(s, now);
+        return;
+    }
+
+    // Паузу не сбрасываем: вернувшийся и сразу отказавший датчик ждет дольше
+    s.ok = true;
+    s.failures = 0;
+    s.lastGood = now;
+    s.changedAt = now;
+    s.since = now;
+    LOG_INFO(SENSORS, EV_SENSOR_RESTORED, "Sensor restored", sensor);
+}
+
+uint8_t SensorHealth::getFailedMask() const
+{
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        if (!states[i].ok)
+            mask |= 1 << i;
+    }
+    return mask;
+}
+
+const __FlashStringHelper* SensorHealth::getName(Sensor sensor)
+{
+    return reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&sensorNames[sensor]));
+}
+
+void SensorHealth::dump(Print& out) const
+{
+    uint32_t now = millis();
+    out.println(F("sensor ok fault failures good_s_ago retry_s"));
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        const State& s = states[i];
+        out.print(getName(static_cast<Sensor>(i)));
+        out.print(s.ok ? F(" ok ") : F(" FAIL "));
+        out.print(reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&faultNames[s.fault])));
+        out.print(' ');
+        out.print(s.failures);
+        out.print(' ');
+        out.print((now - s.lastGood) / 1000UL);
+        out.print(' ');
+        if (s.ok)
+        {
+            out.println('-');
+        }
+        else
+        {
+            int32_t left = static_cast<int32_t>(s.since - now);
+            out.println(left > 0 ? left / 1000L : 0L);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <Arduino.h>
+#include "Log.h"
+
+// Исправность датчиков. Сбоем считается ошибка обмена, значение вне
+// диапазона, замер, не менявшийся stuckMs, и отсутствие хорошего замера
+// дольше staleMs. После FAIL_LIMIT сбоев подряд датчик отключается: его
+// показания не используются, а инициализация повторяется с паузой от
+// RETRY_MIN_MS, удваивающейся после каждой неудачи до RETRY_MAX_MS.
+// Датчик, проработавший после восстановления меньше RETRY_MAX_MS,
+// при новом отказе продолжает с той же длинной паузы.
+class SensorHealth
+{
+public:
+    enum Sensor : uint8_t
+    {
+        LIGHT,
+        AIR_TEMP,
+        AIR_QUAL,
+        SOIL_1,
+        SOIL_2,
+        WATER,
+        SENSOR_COUNT
+    };
+
+    enum Fault : uint8_t
+    {
+        FAULT_NONE,
+        FAULT_INIT,    // не ответил при инициализации
+        FAULT_READ,    // ошибка обмена
+        FAULT_RANGE,
+        FAULT_STUCK,
+        FAULT_STALE
+    };
+
+    // Пределы в единицах getRaw() соответствующего значения
+    struct Limits
+    {
+        int32_t min;
+        int32_t max;
+        uint16_t staleMs;
+        uint16_t stuckMin;  // минут без изменений, 0 - не проверять
+    };
+
+    static const uint8_t FAIL_LIMIT = 3;
+    static const uint32_t RETRY_MIN_MS = 5000;
+    static const uint32_t RETRY_MAX_MS = 600000UL;
+
+private:
+    static const uint8_t MAX_BACKOFF = 7;  // 5 с << 7 уже больше RETRY_MAX_MS
+
+    struct State
+    {
+        int32_t value;
+        uint32_t lastGood;   // millis() последнего хорошего замера
+        uint32_t changedAt;  // когда значение последний раз менялось
+        uint32_t since;      // отказавший - время следующей попытки, исправный - время восстановления
+        uint8_t failures;    // подряд
+        uint8_t backoff;
+        Fault fault;         // последний сбой
+        bool ok;
+    };
+
+    const Limits* limits;  // PROGMEM, SENSOR_COUNT записей
+    State states[SENSOR_COUNT];
+
+    void getLimits(Sensor sensor, Limits& out) const;
+    static void scheduleRetry(State& s, uint32_t now);
+    void lose(Sensor sensor, Fault fault, uint32_t now);
+
+public:
+    explicit SensorHealth(const Limits* limits);
+
+    // Результат инициализации при старте
+    void begin(Sensor sensor, bool ok);
+
+    // Хороший обмен; значение проверяется на диапазон и залипание.
+    // false - значение отброшено
+    bool good(Sensor sensor, int32_t value);
+    void fail(Sensor sensor, Fault fault);
+    // Давно нет хороших замеров - тоже сбой
+    void checkStale();
+
+    // Отказавший датчик, которому пора повторить инициализацию, иначе SENSOR_COUNT
+    Sensor nextRetry() const;
+    void retried(Sensor sensor, bool ok);
+
+    bool isOk(Sensor sensor) const { return states[sensor].ok; }
+    Fault getFault(Sensor sensor) const { return states[sensor].fault; }
+    uint32_t getLastGood(Sensor sensor) const { return states[sensor].lastGood; }
+    // Бит на каждый отказавший датчик
+    uint8_t getFailedMask() const;
+
+    static const __FlashStringHelper* getName(Sensor sensor);
+    void dump(Print& out) const;
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "SensorHistory.h"
+
+// Квант канала в исходных единицах. Подобран так, чтобы обычная скорость
+// изменения за минуту укладывалась в 7 квантов, ступеньки идут через escapes
+static const uint16_t channelUnits[SensorHistory::CHANNEL_COUNT] PROGMEM = {
+    1,    // 0.1 °C
+    2,    // 0.2 %
+    8,    // 8 ppm
+    100,  // 100 лк
+    1,    // 1 %
+    1,    // 1 %
+    100   // 100 мл
+};
+
+SensorHistory::SensorHistory()
+{
+    clear();
+}
+
+void SensorHistory::clear()
+{
+    memset(deltas, 0, sizeof(deltas));
+    memset(last, 0, sizeof(last));
+    head = 0;
+    count = 0;
+    escapeHead = 0;
+    escapeCount = 0;
+}
+
+uint16_t SensorHistory::unitOf(uint8_t channel)
+{
+    return pgm_read_word(&channelUnits[channel]);
+}
+
+int8_t SensorHistory::deltaAt(uint8_t channel, uint8_t index) const
+{
+    uint8_t packed = deltas[channel][index >> 1];
+    uint8_t zigzag = (index & 1) ? (packed >> 4) : (packed & 0x0F);
+    return static_cast<int8_t>((zigzag >> 1) ^ -(zigzag & 1));
+}
+
+void SensorHistory::setDelta(uint8_t channel, uint8_t index, int8_t delta)
+{
+    uint8_t zigzag = static_cast<uint8_t>((delta << 1) ^ (delta >> 7)) & 0x0F;
+    uint8_t& packed = deltas[channel][index >> 1];
+    if (index & 1)
+        packed = (packed & 0x0F) | (zigzag << 4);
+    else
+        packed = (packed & 0xF0) | zigzag;
+}
+
+void SensorHistory::append(const int32_t* values)
+{
+    // Затираемый отсчет уносит свои скачки: они самые старые в очереди
+    if (count == CAPACITY)
+    {
+        for (uint8_t ch = 0; ch < CHANNEL_COUNT; ch++)
+        {
+            if (deltaAt(ch, head) == ESCAPE)
+                escapeCount--;
+        }
+    }
+
+    for (uint8_t ch = 0; ch < CHANNEL_COUNT; ch++)
+    {
+        uint16_t unit = unitOf(ch);
+        int32_t quantized = (values[ch] >= 0 ? values[ch] + unit / 2 : values[ch] - unit / 2) / unit;
+        quantized = constrain(quantized, INT16_MIN, INT16_MAX);
+
+        if (count == 0)
+        {
+            last[ch] = static_cast<int16_t>(quantized);
+            setDelta(ch, head, 0);
+            continue;
+        }
+
+        int32_t delta = quantized - last[ch];
+        if ((delta < DELTA_MIN || delta > DELTA_MAX) && escapeCount < MAX_ESCAPES)
+        {
+            Escape& e = escapes[escapeHead];
+            e.channel = ch;
+            e.delta = static_cast<int16_t>(constrain(delta, INT16_MIN, INT16_MAX));
+            escapeHead = (escapeHead + 1) % MAX_ESCAPES;
+            escapeCount++;
+            last[ch] += e.delta;
+            setDelta(ch, head, ESCAPE);
+            continue;
+        }
+
+        delta = constrain(delta, DELTA_MIN, DELTA_MAX);
+        last[ch] += static_cast<int16_t>(delta);
+        setDelta(ch, head, static_cast<int8_t>(delta));
+    }
+
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY)
+        count++;
+}
+
+bool SensorHistory::query(Channel channel, uint8_t window, Stats& stats) const
+{
+    if (count == 0 || channel >= CHANNEL_COUNT)
+        return false;
+    if (window == 0 || window > count)
+        window = count;
+
+    // Идем от нового к старому: v[i-1] = v[i] - d[i].
+    // x = 2i - (n - 1) симметричен относительно нуля, поэтому sum(x) = 0
+    // и наклон МНК = sum(x*y) / sum(x^2) на полшага x
+    int16_t value = last[channel];
+    int16_t minValue = value;
+    int16_t maxValue = value;
+    int32_t sum = 0;
+    int32_t sumXY = 0;
+    uint8_t index = (head + CAPACITY - 1) % CAPACITY;
+    // Скачки этого канала встречаются в обратном порядке записи
+    uint8_t escape = escapeHead;
+
+    for (uint8_t i = window; i-- > 0;)
+    {
+        int16_t x = 2 * i - (window - 1);
+        sum += value;
+        sumXY += static_cast<int32_t>(x) * value;
+        if (value < minValue)
+            minValue = value;
+        if (value > maxValue)
+            maxValue = value;
+
+        int8_t delta = deltaAt(channel, index);
+        if (delta == ESCAPE)
+        {
+            do
+            {
+                escape = (escape + MAX_ESCAPES - 1) % MAX_ESCAPES;
+            } while (escapes[escape].channel != channel);
+            value -= escapes[escape].delta;
+        }
+        else
+        {
+            value -= delta;
+        }
+        index = (index + CAPACITY - 1) % CAPACITY;
+    }
+
+    uint16_t unit = unitOf(channel);
+    stats.count = window;
+    stats.min = static_cast<int32_t>(minValue) * unit;
+    stats.max = static_cast<int32_t>(maxValue) * unit;
+    stats.avg = (sum * unit + (sum >= 0 ? window / 2 : -(window / 2))) / window;
+
+    // sum(x^2) = n(n^2 - 1)/3, наклон на отсчет = 2 * sumXY / sum(x^2)
+    int32_t sumXX = static_cast<int32_t>(window) * (static_cast<int32_t>(window) * window - 1) / 3;
+    if (sumXX == 0)
+    {
+        stats.slopePerHour = 0;
+    }
+    else
+    {
+        int64_t numerator = static_cast<int64_t>(sumXY) * 2 * SAMPLES_PER_HOUR * unit;
+        stats.slopePerHour = static_cast<int32_t>((numerator + (numerator >= 0 ? sumXX / 2 : -(sumXX / 2))) / sumXX);
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <Arduino.h>
+
+// История показаний по каналам с периодом SAMPLE_PERIOD_MS.
+// Хранятся только приращения: 4 бита на отсчет (zig-zag, -7..+7 квантов),
+// значение в кванте канала (0.1 °C, 8 ppm, 100 лк, ...). Код -8 - скачок
+// больше (включение лампы, долив бака): само приращение лежит в общей для
+// всех каналов очереди escapes. Пока в окне уже MAX_ESCAPES скачков, новый
+// обрезается до 7 квантов и догоняется следующими отсчетами. Добавление O(1);
+// запросы идут назад от последнего значения прямо по буферу, без копирования.
+class SensorHistory
+{
+public:
+    enum Channel : uint8_t
+    {
+        CH_TEMPERATURE,  // DeciCelsius
+        CH_HUMIDITY,     // DeciPercent
+        CH_CO2,          // ppm
+        CH_LIGHT,        // лк
+        CH_SOIL_1,       // %
+        CH_SOIL_2,       // %
+        CH_WATER,        // мл
+        CHANNEL_COUNT
+    };
+
+    static const uint8_t CAPACITY = 120;  // отсчетов на канал: 2 часа
+    static const uint32_t SAMPLE_PERIOD_MS = 60000UL;
+    static const uint8_t SAMPLES_PER_HOUR = 3600000UL / SAMPLE_PERIOD_MS;
+
+    // Все значения - в исходных единицах канала
+    struct Stats
+    {
+        int32_t min;
+        int32_t max;
+        int32_t avg;
+        int32_t slopePerHour;  // МНК по окну
+        uint8_t count;
+    };
+
+private:
+    static const int8_t DELTA_MIN = -7;
+    static const int8_t DELTA_MAX = 7;
+    static const int8_t ESCAPE = -8;
+    static const uint8_t MAX_ESCAPES = 8;
+
+    // Скачки в порядке записи; старейший уходит вместе со своим отсчетом
+    struct Escape
+    {
+        uint8_t channel;
+        int16_t delta;  // в квантах
+    };
+
+    uint8_t deltas[CHANNEL_COUNT][CAPACITY / 2];  // два отсчета в байте
+    int16_t last[CHANNEL_COUNT];                  // последнее значение в квантах
+    uint8_t head;                                 // куда писать следующий отсчет
+    uint8_t count;
+    Escape escapes[MAX_ESCAPES];
+    uint8_t escapeHead;   // куда писать следующий скачок
+    uint8_t escapeCount;  // скачков в буфере
+
+    static uint16_t unitOf(uint8_t channel);
+    int8_t deltaAt(uint8_t channel, uint8_t index) const;
+    void setDelta(uint8_t channel, uint8_t index, int8_t delta);
+
+public:
+    SensorHistory();
+
+    // values[CHANNEL_COUNT] в исходных единицах каналов
+    void append(const int32_t* values);
+    void clear();
+
+    // Статистика по последним window отсчетам (0 - по всем). false, если отсчетов нет
+    bool query(Channel channel, uint8_t window, Stats& stats) const;
+
+    int32_t latest(Channel channel) const { return static_cast<int32_t>(last[channel]) * unitOf(channel); }
+    uint8_t size() const { return count; }
+};
+
+#endif
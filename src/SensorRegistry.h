@@ -0,0 +1,106 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <Arduino.h>
+#include "SensorHealth.h"
+
+// Датчик объявляется классом, унаследованным от SensorDriver<Сам, ID>:
+//   bool begin();                  // инициализация, она же повторная после отказа
+//   void read(SensorHealth& h);    // замер на каждом updateAll(), успех/сбой - в h
+//   void poll();                   // необязательно: быстрый шаг на каждом poll()
+// и хранит свои значения с геттерами. ID - номер в SensorHealth; NO_HEALTH -
+// датчик без надзора (сам повторяет связь).
+//
+// SensorList<A, B, ...> собирает датчики наследованием: обход разворачивается
+// при компиляции в прямые вызовы, без виртуальных функций и кучи. Порядок
+// в списке - порядок инициализации и опроса.
+
+static const SensorHealth::Sensor NO_HEALTH = SensorHealth::SENSOR_COUNT;
+
+template <class Derived, SensorHealth::Sensor ID>
+class SensorDriver
+{
+public:
+    static const SensorHealth::Sensor HEALTH_ID = ID;
+
+    // Обработчики по умолчанию, датчик переопределяет нужные
+    void poll() {}
+
+    bool start(SensorHealth& health)
+    {
+        bool ok = self().begin();
+        if (ID != NO_HEALTH)
+            health.begin(ID, ok);
+        return ok;
+    }
+
+    void pollIfOk(const SensorHealth& health)
+    {
+        if (ID == NO_HEALTH || health.isOk(ID))
+            self().poll();
+    }
+
+    void update(SensorHealth& health)
+    {
+        if (ID == NO_HEALTH || health.isOk(ID))
+            self().read(health);
+    }
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+template <class... Sensors>
+class SensorList;
+
+template <>
+class SensorList<>
+{
+public:
+    bool startAll(SensorHealth&) { return true; }
+    void pollAll(const SensorHealth&) {}
+    void updateAll(SensorHealth&) {}
+    bool restart(SensorHealth::Sensor) { return false; }
+};
+
+template <class Head, class... Tail>
+class SensorList<Head, Tail...> : public Head, public SensorList<Tail...>
+{
+private:
+    typedef SensorList<Tail...> Rest;
+
+public:
+    bool startAll(SensorHealth& health)
+    {
+        bool ok = Head::start(health);
+        return Rest::startAll(health) && ok;
+    }
+
+    void pollAll(const SensorHealth& health)
+    {
+        Head::pollIfOk(health);
+        Rest::pollAll(health);
+    }
+
+    void updateAll(SensorHealth& health)
+    {
+        Head::update(health);
+        Rest::updateAll(health);
+    }
+
+    // Повторная инициализация датчика с этим номером SensorHealth
+    bool restart(SensorHealth::Sensor id)
+    {
+        if (Head::HEALTH_ID != NO_HEALTH && Head::HEALTH_ID == id)
+            return Head::begin();
+        return Rest::restart(id);
+    }
+
+    // Доступ к датчику по типу: sensors.get<LightSensor>()
+    template <class Sensor>
+    Sensor& get() { return *this; }
+    template <class Sensor>
+    const Sensor& get() const { return *this; }
+};
+
+#endif
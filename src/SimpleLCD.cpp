@@ -2,20 +2,25 @@
 
 // Конструктор
 GreenhouseDisplay::GreenhouseDisplay(uint8_t lcdAddr, uint8_t lcdCols, uint8_t lcdRows)
-        : isInitialized(false), currentMode(MODE_CLOCK), blinkState(false) {
+        : frame(lcdCols, lcdRows), isInitialized(false), backlightState(false), currentMode(MODE_CLOCK),
+          blinkState(false), errorScrollPos(0), messageCount(0) {
 
     lcd = new LiquidCrystal_I2C(lcdAddr, lcdCols, lcdRows);
 
     // Инициализация данных нулевыми значениями
-    memset(&data, 0, sizeof(data));
+    data = DisplayData();
     data.isAutoMode = true;
+    data.freeMemory = UINT16_MAX;
     data.hasError = false;
 }
 
 // Инициализация дисплея
 void GreenhouseDisplay::begin() {
+    if (!I2cBus::select(I2cBus::DEV_LCD)) return;
     lcd->begin();
+    I2cBus::wireRestarted();
     lcd->backlight();
+    backlightState = true;
     lcd->clear();
 
     isInitialized = true;
@@ -25,11 +30,12 @@ void GreenhouseDisplay::begin() {
 
     // Приветственное сообщение
     lcd->setCursor(0, 0);
-    lcd->print("Smart Greenhouse");
+    lcd->print(F("Smart Greenhouse"));
     lcd->setCursor(0, 1);
-    lcd->print("ver. 0");
+    lcd->print(F("ver. 0"));
+    I2cBus::finish(I2cBus::DEV_LCD, true);
     delay(1500);
-    lcd->clear();
+    clear();
 }
 
 // Основной метод обновления
@@ -46,8 +52,10 @@ void GreenhouseDisplay::update() {
         lastModeChange = currentTime;
     }
 
-    // Обновление дисплея каждую секунду
-    if (currentTime - lastUpdate > 1000) {
+    updateMessages(currentTime);
+
+    // Обновление дисплея: отправляются только изменившиеся символы
+    if (currentTime - lastUpdate >= REFRESH_INTERVAL_MS) {
         updateDisplay();
         lastUpdate = currentTime;
     }
@@ -56,13 +64,29 @@ void GreenhouseDisplay::update() {
     if (currentTime - lastBlink > 500) {
         blinkState = !blinkState;
         lastBlink = currentTime;
+        if (data.hasError) {
+            errorScrollPos++;
+        }
     }
 }
 
 // Обновление отображения
 void GreenhouseDisplay::updateDisplay() {
-    lcd->clear();
-    if (data.lightLevel < 100){
+    frame.clear();
+
+    // Сообщение перекрывает текущий режим целиком
+    int8_t message = topMessage();
+    if (message >= 0) {
+        backlightOn();
+        showOverlay(messages[message]);
+        if (I2cBus::select(I2cBus::DEV_LCD)) {
+            frame.flush(*lcd);
+            if (!I2cBus::finish(I2cBus::DEV_LCD, true)) frame.invalidate();
+        }
+        return;
+    }
+
+    if (data.lightLevel < Lux::fromInt(100)){
         backlightOff();
     } else {
         backlightOn();
@@ -94,74 +118,95 @@ void GreenhouseDisplay::updateDisplay() {
 
     // Отображение индикаторов состояния
     drawStatusIndicators();
+
+    // Пока шина стоит, кадр не выводится. Экран после сбоя мог сохранить мусор,
+    // поэтому следующий кадр рисуется целиком
+    if (I2cBus::select(I2cBus::DEV_LCD)) {
+        frame.flush(*lcd);
+        if (!I2cBus::finish(I2cBus::DEV_LCD, true)) frame.invalidate();
+    }
 }
 
 // Режим: Часы и дата
 void GreenhouseDisplay::showClock() {
-    lcd->setCursor(0, 0);
-    lcd->print("Time: ");
-    lcd->print(formatTime());
+    frame.setCursor(0, 0);
+    char buffer[FORMAT_BUFFER_SIZE];
 
-    lcd->setCursor(0, 1);
-    lcd->print("Date: ");
-    lcd->print(formatDate());
+    frame.print(F("Time: "));
+    formatTime(buffer);
+    frame.print(buffer);
+
+    frame.setCursor(0, 1);
+    frame.print(F("Date: "));
+    formatDate(buffer);
+    frame.print(buffer);
 }
 
 // Режим: Температура и влажность
 void GreenhouseDisplay::showTempHum() {
-    lcd->setCursor(0, 0);
-    lcd->print("T:");
-    lcd->print(formatTemperature());
-    lcd->print("C");
-
-    lcd->setCursor(8, 0);
-    lcd->print("H:");
-    lcd->print(formatHumidity());
-    lcd->print("%");
+    char buffer[FORMAT_BUFFER_SIZE];
+
+    frame.setCursor(0, 0);
+    frame.print(F("T:"));
+    formatTemperature(buffer);
+    frame.print(buffer);
+    frame.print(F("C"));
+
+    frame.setCursor(8, 0);
+    frame.print(F("H:"));
+    formatHumidity(buffer);
+    frame.print(buffer);
+    frame.print(F("%"));
     /*
     // Качество воздуха на второй строке
-    lcd->setCursor(0, 1);
-    lcd->print("AQI:");
-    lcd->print(data.airQuality, 0);
+    frame.setCursor(0, 1);
+    frame.print(F("AQI:"));
+    frame.print(data.airQuality, 0);
 
     // Индикатор качества
-    lcd->setCursor(9, 1);
+    frame.setCursor(9, 1);
     if (data.airQuality < 50) {
-        lcd->print("Good");
+        frame.print(F("Good"));
     } else if (data.airQuality < 100) {
-        lcd->print("Fair");
+        frame.print(F("Fair"));
     } else {
-        lcd->print("Poor");
+        frame.print(F("Poor"));
     }
     */
     // Качество воздуха на второй строке
-    lcd->setCursor(0, 1);
-    lcd->print("CO2:");
-    lcd->print(data.airQuality);
+    frame.setCursor(0, 1);
+    frame.print(F("CO2:"));
+    appendNumber(buffer, data.airQuality.getRaw(), 0, 0, ' ');
+    frame.print(buffer);
 
     // Индикатор качества
-    lcd->setCursor(9, 1);
+    frame.setCursor(9, 1);
+
+    frame.setCursor(12, 1);
+    frame.print(F("T:"));
+    frame.write(trendChar(data.temperatureTrend));
 }
 
 // Режим: Влажность почвы
 void GreenhouseDisplay::showSoil() {
     uint8_t avgSoil = (data.soilMoisture1 + data.soilMoisture2) / 2;
 
-    lcd->setCursor(0, 0);
-    lcd->print("Soil Moisture");
+    frame.setCursor(0, 0);
+    frame.print(F("Soil Moisture"));
 
-    lcd->setCursor(0, 1);
-    lcd->print("S1:");
-    lcd->print(data.soilMoisture1);
-    lcd->print("% ");
+    frame.setCursor(0, 1);
+    frame.print(F("S1:"));
+    frame.print(data.soilMoisture1);
+    frame.print(F("% "));
+    frame.write(trendChar(data.soilTrend));
     /*
-    lcd->setCursor(8, 1);
-    lcd->print("S2:");
-    lcd->print(data.soilMoisture2);
-    lcd->print("%");
+    frame.setCursor(8, 1);
+    frame.print(F("S2:"));
+    frame.print(data.soilMoisture2);
+    frame.print(F("%"));
     */
     // Графический индикатор средней влажности
-    lcd->setCursor(14, 1);
+    frame.setCursor(14, 1);
     uint8_t level = map(avgSoil, 0, 100, 0, 5);
     char levelChar;
     switch (level) {
@@ -173,82 +218,93 @@ void GreenhouseDisplay::showSoil() {
         case 5: levelChar = 5; break;   // Полный
         default: levelChar = '?';
     }
-    lcd->write(levelChar);
+    frame.write(levelChar);
 }
 
 // Режим: Освещенность и вода
 void GreenhouseDisplay::showLightWater() {
-    lcd->setCursor(0, 0);
-    lcd->print("Light:");
-    lcd->print(formatLight());
+    char buffer[FORMAT_BUFFER_SIZE];
 
-    lcd->setCursor(0, 1);
-    lcd->print("Water:");
-    lcd->print(formatWater());
+    frame.setCursor(0, 0);
+    frame.print(F("Light:"));
+    formatLight(buffer);
+    frame.print(buffer);
+
+    frame.setCursor(0, 1);
+    frame.print(F("Water:"));
+    formatWater(buffer);
+    frame.print(buffer);
 
     // Индикатор уровня воды (графический)
-    lcd->setCursor(15, 1);
-    if (data.waterVolume > 2000) {
-        lcd->write(5);  // Полный
-    } else if (data.waterVolume > 1000) {
-        lcd->write(4);  // Высокий
-    } else if (data.waterVolume > 500) {
-        lcd->write(3);  // Средний
-    } else if (data.waterVolume > 100) {
-        lcd->write(2);  // Низкий
-    } else if (data.waterVolume > 0) {
-        lcd->write(1);  // Очень низкий
+    frame.setCursor(15, 1);
+    if (data.waterVolume > Millilitres::fromInt(2000)) {
+        frame.write(5);  // Полный
+    } else if (data.waterVolume > Millilitres::fromInt(1000)) {
+        frame.write(4);  // Высокий
+    } else if (data.waterVolume > Millilitres::fromInt(500)) {
+        frame.write(3);  // Средний
+    } else if (data.waterVolume > Millilitres::fromInt(100)) {
+        frame.write(2);  // Низкий
+    } else if (data.waterVolume > Millilitres::fromInt(0)) {
+        frame.write(1);  // Очень низкий
     } else {
-        lcd->print("!"); // Пусто
+        frame.print(F("!")); // Пусто
     }
 }
 
 // Режим: Состояние системы
 void GreenhouseDisplay::showSystem() {
-    lcd->setCursor(0, 0);
-    lcd->print("Mode: ");
-    lcd->print(data.isAutoMode ? "Auto" : "Manual");
+    frame.setCursor(0, 0);
+    frame.print(data.isAutoMode ? F("Auto") : F("Manual"));
+
+    // Запас RAM до столкновения стека с кучей; колонка 15 занята индикатором
+    frame.setCursor(7, 0);
+    frame.print(F("Mem"));
+    if (data.freeMemory == UINT16_MAX) {
+        frame.print(F("   ?"));
+    } else {
+        char buffer[FORMAT_BUFFER_SIZE];
+        appendNumber(buffer, data.freeMemory, 0, 4, ' ');
+        frame.print(buffer);
+    }
 
-    lcd->setCursor(0, 1);
-    lcd->print("L:");
-    lcd->print(data.lightOn ? "ON " : "OFF");
+    frame.setCursor(0, 1);
+    frame.print(F("L:"));
+    frame.print(data.lightOn ? F("ON ") : F("OFF"));
 
-    lcd->setCursor(5, 1);
-    lcd->print("F:");
-    lcd->print(data.fanOn ? "ON " : "OFF");
+    frame.setCursor(5, 1);
+    frame.print(F("F:"));
+    frame.print(data.fanOn ? F("ON ") : F("OFF"));
 
-    lcd->setCursor(11, 1);
-    lcd->print("P:");
-    lcd->print(data.pumpOn ? "ON" : "OFF");
+    frame.setCursor(11, 1);
+    frame.print(F("P:"));
+    frame.print(data.pumpOn ? F("ON") : F("OFF"));
 }
 
 // Режим: Ошибки
 void GreenhouseDisplay::showError() {
-    lcd->setCursor(0, 0);
-    lcd->print("! ERROR !");
+    frame.setCursor(0, 0);
+    frame.print(F("! ERROR !"));
 
-    // Прокрутка текста ошибки на второй строке
-    static uint8_t scrollPos = 0;
-    String displayText;
+    // Прокрутка текста ошибки на второй строке (шаг - в update())
+    uint8_t length = strlen(data.errorMessage);
+    uint8_t visible = frame.getCols();
 
-    if (data.errorMessage.length() <= 16) {
-        displayText = data.errorMessage;
+    frame.setCursor(0, 1);
+    if (length <= visible) {
+        frame.print(data.errorMessage);
     } else {
-        displayText = data.errorMessage.substring(scrollPos, scrollPos + 16);
-        scrollPos++;
-        if (scrollPos > data.errorMessage.length() - 16) {
-            scrollPos = 0;
+        if (errorScrollPos > length - visible) {
+            errorScrollPos = 0;
         }
+        frame.write(reinterpret_cast<const uint8_t*>(data.errorMessage) + errorScrollPos, visible);
     }
 
-    lcd->setCursor(0, 1);
-    lcd->print(displayText);
-
     // Мигание подсветкой при ошибке
     if (blinkState) {
-        lcd->backlight();
+        backlightOn();
     } else {
-        lcd->noBacklight();
+        backlightOff();
     }
 }
 
@@ -257,78 +313,111 @@ void GreenhouseDisplay::drawStatusIndicators() {
     if (data.hasError) return;
 
     // Индикатор режима в правом верхнем углу
-    lcd->setCursor(15, 0);
+    frame.setCursor(15, 0);
     if (data.isAutoMode) {
-        lcd->print("A");
+        frame.print(F("A"));
     } else {
-        lcd->print("M");
+        frame.print(F("M"));
     }
 
     // Индикатор ошибки или состояния
-    lcd->setCursor(15, 0);
+    frame.setCursor(15, 0);
     if (data.hasError) {
-        lcd->print("!");
+        frame.print(F("!"));
     } else if (data.pumpOn) {
-        lcd->print("P");
+        frame.print(F("P"));
     } else if (data.lightOn && blinkState) {
-        lcd->print("*");
+        frame.print(F("*"));
     } else if (data.fanOn && blinkState) {
-        lcd->print("~");
+        frame.print(F("~"));
     } else {
-        lcd->print("");
+        frame.print(F(""));
+    }
+}
+
+// Целое со сдвинутой запятой (value = число * 10^decimals), выравнивание
+// вправо до width символов. Возвращает указатель на завершающий '\0'
+char* GreenhouseDisplay::appendNumber(char* out, int32_t value, uint8_t decimals, uint8_t width, char pad) {
+    char digits[12];
+    uint8_t len = 0;
+    bool negative = value < 0;
+    uint32_t v = negative ? -static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+
+    // Цифры собираются в обратном порядке
+    do {
+        if (decimals != 0 && len == decimals) {
+            digits[len++] = '.';
+        }
+        digits[len++] = '0' + v % 10;
+        v /= 10;
+    } while (v != 0 || len <= decimals);
+
+    if (negative) {
+        digits[len++] = '-';
+    }
+    for (uint8_t i = len; i < width; i++) {
+        *out++ = pad;
+    }
+    while (len > 0) {
+        *out++ = digits[--len];
+    }
+    *out = '\0';
+    return out;
+}
+
+char* GreenhouseDisplay::appendP(char* out, PGM_P text) {
+    char c;
+    while ((c = pgm_read_byte(text++)) != '\0') {
+        *out++ = c;
     }
+    *out = '\0';
+    return out;
 }
 
 // Форматирование времени
-String GreenhouseDisplay::formatTime() {
-    char buffer[9];
-    sprintf(buffer, "%02d:%02d", data.hour, data.minute);
-    return String(buffer);
+void GreenhouseDisplay::formatTime(char* buffer) {
+    char* p = appendNumber(buffer, data.hour, 0, 2, '0');
+    *p++ = ':';
+    appendNumber(p, data.minute, 0, 2, '0');
 }
 
 // Форматирование даты
-String GreenhouseDisplay::formatDate() {
-    char buffer[11];
+void GreenhouseDisplay::formatDate(char* buffer) {
     //TODO: Fix (everything)
-    sprintf(buffer, "%02d.%02d.%02d", data.day, data.month, data.year%100 - 8);
-    return String(buffer);
+    char* p = appendNumber(buffer, data.day, 0, 2, '0');
+    *p++ = '.';
+    p = appendNumber(p, data.month, 0, 2, '0');
+    *p++ = '.';
+    appendNumber(p, data.year % 100, 0, 2, '0');
 }
 
 // Форматирование температуры
-String GreenhouseDisplay::formatTemperature() {
-    char buffer[6];
-    dtostrf(data.temperature, 4, 1, buffer);
-    return String(buffer);
+void GreenhouseDisplay::formatTemperature(char* buffer) {
+    appendNumber(buffer, data.temperature.getRaw(), 1, 4, ' ');
 }
 
 // Форматирование влажности
-String GreenhouseDisplay::formatHumidity() {
-    char buffer[6];
-    dtostrf(data.humidity, 2, 0, buffer);
-    return String(buffer);
+void GreenhouseDisplay::formatHumidity(char* buffer) {
+    appendNumber(buffer, data.humidity.toInt(), 0, 2, ' ');
 }
 
 // Форматирование освещенности
-String GreenhouseDisplay::formatLight() {
-    char buffer[8];
-    if (data.lightLevel < 1000) {
-        dtostrf(data.lightLevel, 4, 0, buffer);
-        return String(buffer) + "lx";
+void GreenhouseDisplay::formatLight(char* buffer) {
+    uint32_t lux = data.lightLevel.getRaw();
+    if (lux < 1000) {
+        appendP(appendNumber(buffer, lux, 0, 4, ' '), PSTR("lx"));
     } else {
-        dtostrf(data.lightLevel / 1000.0, 4, 1, buffer);
-        return String(buffer) + "klx";
+        appendP(appendNumber(buffer, (lux + 50) / 100, 1, 4, ' '), PSTR("klx"));
     }
 }
 
 // Форматирование объема воды
-String GreenhouseDisplay::formatWater() {
-    char buffer[8];
-    if (data.waterVolume < 1000) {
-        dtostrf(data.waterVolume, 4, 0, buffer);
-        return String(buffer) + "ml";
+void GreenhouseDisplay::formatWater(char* buffer) {
+    uint32_t ml = data.waterVolume.getRaw();
+    if (ml < 1000) {
+        appendP(appendNumber(buffer, ml, 0, 4, ' '), PSTR("ml"));
     } else {
-        dtostrf(data.waterVolume / 1000.0, 4, 1, buffer);
-        return String(buffer) + "L";
+        appendP(appendNumber(buffer, (ml + 50) / 100, 1, 4, ' '), PSTR("L"));
     }
 }
 
@@ -344,11 +433,11 @@ void GreenhouseDisplay::setDate(uint8_t d, uint8_t mo, uint16_t y) {
     data.year = y;
 }
 
-void GreenhouseDisplay::setTemperature(float temp) {
+void GreenhouseDisplay::setTemperature(DeciCelsius temp) {
     data.temperature = temp;
 }
 
-void GreenhouseDisplay::setHumidity(float hum) {
+void GreenhouseDisplay::setHumidity(DeciPercent hum) {
     data.humidity = hum;
 }
 
@@ -360,18 +449,30 @@ void GreenhouseDisplay::setSoilMoisture2(uint8_t moisture) {
     data.soilMoisture2 = moisture;
 }
 
-void GreenhouseDisplay::setLightLevel(float level) {
+void GreenhouseDisplay::setLightLevel(Lux level) {
     data.lightLevel = level;
 }
 
-void GreenhouseDisplay::setWaterVolume(float volume) {
+void GreenhouseDisplay::setWaterVolume(Millilitres volume) {
     data.waterVolume = volume;
 }
 
-void GreenhouseDisplay::setAirQuality(float quality) {
+void GreenhouseDisplay::setAirQuality(Ppm quality) {
     data.airQuality = quality;
 }
 
+void GreenhouseDisplay::setTemperatureTrend(int8_t trend) {
+    data.temperatureTrend = trend;
+}
+
+void GreenhouseDisplay::setSoilTrend(int8_t trend) {
+    data.soilTrend = trend;
+}
+
+char GreenhouseDisplay::trendChar(int8_t trend) {
+    return trend > 0 ? '^' : (trend < 0 ? 'v' : '-');
+}
+
 void GreenhouseDisplay::setAutoMode(bool autoMode) {
     data.isAutoMode = autoMode;
 }
@@ -388,28 +489,53 @@ void GreenhouseDisplay::setPumpState(bool state) {
     data.pumpOn = state;
 }
 
-void GreenhouseDisplay::setError(const String& message) {
+void GreenhouseDisplay::setFreeMemory(uint16_t bytes) {
+    data.freeMemory = bytes;
+}
+
+void GreenhouseDisplay::setError(const char* message) {
+    strncpy(data.errorMessage, message, ERROR_MESSAGE_LENGTH);
+    data.errorMessage[ERROR_MESSAGE_LENGTH] = '\0';
+    data.hasError = true;
+    setMode(MODE_ERROR);
+}
+
+void GreenhouseDisplay::setError(const __FlashStringHelper* message) {
+    strncpy_P(data.errorMessage, reinterpret_cast<PGM_P>(message), ERROR_MESSAGE_LENGTH);
+    data.errorMessage[ERROR_MESSAGE_LENGTH] = '\0';
     data.hasError = true;
-    data.errorMessage = message;
     setMode(MODE_ERROR);
 }
 
 void GreenhouseDisplay::clearError() {
     data.hasError = false;
-    data.errorMessage = "";
-    lcd->backlight();
+    data.errorMessage[0] = '\0';
+    backlightOn();
 }
 
 void GreenhouseDisplay::clear() {
-    lcd->clear();
+    if (I2cBus::select(I2cBus::DEV_LCD)) {
+        lcd->clear();
+        I2cBus::finish(I2cBus::DEV_LCD, true);
+        frame.markCleared();
+    }
 }
 
+// Подсветка переключается только при смене состояния, чтобы не гонять шину
 void GreenhouseDisplay::backlightOn() {
-    lcd->backlight();
+    if (!backlightState && I2cBus::select(I2cBus::DEV_LCD)) {
+        lcd->backlight();
+        I2cBus::finish(I2cBus::DEV_LCD, true);
+        backlightState = true;
+    }
 }
 
 void GreenhouseDisplay::backlightOff() {
-    lcd->noBacklight();
+    if (backlightState && I2cBus::select(I2cBus::DEV_LCD)) {
+        lcd->noBacklight();
+        I2cBus::finish(I2cBus::DEV_LCD, true);
+        backlightState = false;
+    }
 }
 
 void GreenhouseDisplay::setMode(DisplayMode mode) {
@@ -419,22 +545,116 @@ void GreenhouseDisplay::setMode(DisplayMode mode) {
 
 void GreenhouseDisplay::nextMode() {
     currentMode = static_cast<DisplayMode>((currentMode + 1) % 5); // 5 режимов кроме ERROR
-    lcd->clear();
 }
 
-void GreenhouseDisplay::showMessage(const String& line1, const String& line2, uint16_t duration) {
-    lcd->clear();
+void GreenhouseDisplay::showMessage(const char* line1, const char* line2, uint16_t duration, uint8_t priority) {
+    char text1[MESSAGE_LENGTH + 1];
+    char text2[MESSAGE_LENGTH + 1];
+    strncpy(text1, line1, MESSAGE_LENGTH);
+    text1[MESSAGE_LENGTH] = '\0';
+    strncpy(text2, line2, MESSAGE_LENGTH);
+    text2[MESSAGE_LENGTH] = '\0';
+    queueMessage(text1, text2, duration, priority);
+}
+
+void GreenhouseDisplay::showMessage(const __FlashStringHelper* line1, const __FlashStringHelper* line2,
+                                    uint16_t duration, uint8_t priority) {
+    char text1[MESSAGE_LENGTH + 1];
+    char text2[MESSAGE_LENGTH + 1] = "";
+    strncpy_P(text1, reinterpret_cast<PGM_P>(line1), MESSAGE_LENGTH);
+    text1[MESSAGE_LENGTH] = '\0';
+    if (line2 != nullptr) {
+        strncpy_P(text2, reinterpret_cast<PGM_P>(line2), MESSAGE_LENGTH);
+        text2[MESSAGE_LENGTH] = '\0';
+    }
+    queueMessage(text1, text2, duration, priority);
+}
+
+void GreenhouseDisplay::queueMessage(const char* line1, const char* line2, uint16_t duration, uint8_t priority) {
+    // То же сообщение уже в очереди - не дублируем. Таймер показа не трогаем:
+    // иначе повтор каждые 10 с держал бы его на экране вечно
+    for (uint8_t i = 0; i < messageCount; i++) {
+        Message& m = messages[i];
+        if (strcmp(m.line1, line1) == 0 && strcmp(m.line2, line2) == 0) {
+            if (!m.started) {
+                m.duration = duration;
+            }
+            if (priority > m.priority) {
+                m.priority = priority;
+            }
+            return;
+        }
+    }
 
-    if (line1.length() > 0) {
-        lcd->setCursor(0, 0);
-        lcd->print(line1);
+    if (messageCount >= MAX_MESSAGES) {
+        // Очередь полна: вытесняем самое старое из наименее приоритетных
+        uint8_t lowest = 0;
+        for (uint8_t i = 1; i < messageCount; i++) {
+            if (messages[i].priority < messages[lowest].priority) {
+                lowest = i;
+            }
+        }
+        if (messages[lowest].priority > priority) {
+            return;
+        }
+        removeMessage(lowest);
     }
 
-    if (line2.length() > 0) {
-        lcd->setCursor(0, 1);
-        lcd->print(line2);
+    Message& m = messages[messageCount++];
+    strcpy(m.line1, line1);
+    strcpy(m.line2, line2);
+    m.duration = duration;
+    m.shownAt = 0;
+    m.priority = priority;
+    m.started = false;
+
+    // Показать без ожидания следующего периода обновления
+    lastUpdate = millis() - REFRESH_INTERVAL_MS;
+}
+
+void GreenhouseDisplay::clearMessages() {
+    messageCount = 0;
+}
+
+// Снятие истекших сообщений и запуск таймера у того, что сейчас на экране
+void GreenhouseDisplay::updateMessages(unsigned long currentTime) {
+    uint8_t i = 0;
+    while (i < messageCount) {
+        if (messages[i].started && currentTime - messages[i].shownAt >= messages[i].duration) {
+            removeMessage(i);
+        } else {
+            i++;
+        }
     }
 
-    delay(duration);
-    lcd->clear();
-}
\ No newline at end of file
+    int8_t top = topMessage();
+    if (top >= 0 && !messages[top].started) {
+        messages[top].started = true;
+        messages[top].shownAt = currentTime;
+    }
+}
+
+// Самое приоритетное сообщение, при равенстве - самое раннее
+int8_t GreenhouseDisplay::topMessage() const {
+    int8_t top = -1;
+    for (uint8_t i = 0; i < messageCount; i++) {
+        if (top < 0 || messages[i].priority > messages[top].priority) {
+            top = i;
+        }
+    }
+    return top;
+}
+
+void GreenhouseDisplay::removeMessage(uint8_t index) {
+    for (uint8_t i = index + 1; i < messageCount; i++) {
+        messages[i - 1] = messages[i];
+    }
+    messageCount--;
+}
+
+void GreenhouseDisplay::showOverlay(const Message& message) {
+    frame.setCursor(0, 0);
+    frame.print(message.line1);
+    frame.setCursor(0, 1);
+    frame.print(message.line2);
+}
@@ -2,13 +2,23 @@
 #define GREENHOUSE_DISPLAY_H
 
 #include <Arduino.h>
-#include <Wire.h>
+#include "I2cBus.h"
+#include <avr/pgmspace.h>
 #include "LiquidCrystal_I2C.h"
+#include "LcdFrameBuffer.h"
+#include "FixedPoint.h"
 
 class GreenhouseDisplay {
+public:
+    static const uint8_t ERROR_MESSAGE_LENGTH = 32;  // длиннее - прокрутка
+
 private:
     LiquidCrystal_I2C* lcd;
+    LcdFrameBuffer frame;   // теневой буфер, show* рисуют в него
     bool isInitialized;
+    bool backlightState;
+
+    static const uint16_t REFRESH_INTERVAL_MS = 100;
 
     // Режимы отображения
     enum DisplayMode {
@@ -25,6 +35,10 @@ private:
     unsigned long lastUpdate;
     unsigned long lastBlink;
     bool blinkState;
+    uint8_t errorScrollPos;
+
+    // Минимальный размер буфера для format*
+    static const uint8_t FORMAT_BUFFER_SIZE = 12;
 
     // Структура для хранения данных
     struct DisplayData {
@@ -36,29 +50,54 @@ private:
         uint16_t year;
 
         // Данные датчиков
-        float temperature;
-        float humidity;
+        DeciCelsius temperature;
+        DeciPercent humidity;
         uint8_t soilMoisture1;
         uint8_t soilMoisture2;
-        float lightLevel;
-        float waterVolume;
-        float airQuality;
+        Lux lightLevel;
+        Millilitres waterVolume;
+        Ppm airQuality;
+        // Тренды по истории: -1 падает, 0 стоит, 1 растет
+        int8_t temperatureTrend;
+        int8_t soilTrend;
 
         // Состояние системы
         bool isAutoMode;
         bool lightOn;
         bool fanOn;
         bool pumpOn;
+        uint16_t freeMemory;  // нетронутые байты RAM, UINT16_MAX - неизвестно
 
         // Ошибки
         bool hasError;
-        String errorMessage;
+        char errorMessage[ERROR_MESSAGE_LENGTH + 1];
     };
 
     DisplayData data;
 
+    // Очередь сообщений поверх текущего режима
+    static const uint8_t MAX_MESSAGES = 4;
+    static const uint8_t MESSAGE_LENGTH = 16;
+
+    struct Message {
+        char line1[MESSAGE_LENGTH + 1];
+        char line2[MESSAGE_LENGTH + 1];
+        uint16_t duration;     // мс показа
+        uint32_t shownAt;      // когда сообщение впервые попало на экран
+        uint8_t priority;
+        bool started;
+    };
+
+    Message messages[MAX_MESSAGES];  // в порядке поступления
+    uint8_t messageCount;
+
     // Приватные методы
     void updateDisplay();
+    void updateMessages(unsigned long currentTime);
+    int8_t topMessage() const;
+    void removeMessage(uint8_t index);
+    void queueMessage(const char* line1, const char* line2, uint16_t duration, uint8_t priority);
+    void showOverlay(const Message& message);
     void showClock();
     void showTempHum();
     void showSoil();
@@ -66,22 +105,29 @@ private:
     void showSystem();
     void showError();
 
-    void printTwoLines(const String& line1, const String& line2);
-    void printCenter(const String& text, uint8_t row);
-    void scrollText(const String& text, uint8_t row);
+    // Вспомогательные функции форматирования (без кучи и printf).
+    // buffer - не меньше FORMAT_BUFFER_SIZE
+    void formatTime(char* buffer);
+    void formatDate(char* buffer);
+    void formatTemperature(char* buffer);
+    void formatHumidity(char* buffer);
+    void formatLight(char* buffer);
+    void formatWater(char* buffer);
 
-    // Вспомогательные функции форматирования
-    String formatTime();
-    String formatDate();
-    String formatTemperature();
-    String formatHumidity();
-    String formatLight();
-    String formatWater();
+    static char* appendNumber(char* out, int32_t value, uint8_t decimals, uint8_t width, char pad);
+    static char* appendP(char* out, PGM_P text);
 
     // Индикаторы состояния
     void drawStatusIndicators();
+    static char trendChar(int8_t trend);
 
 public:
+    enum MessagePriority : uint8_t {
+        PRIORITY_INFO = 0,
+        PRIORITY_WARNING = 1,
+        PRIORITY_ALERT = 2
+    };
+
     GreenhouseDisplay(uint8_t lcdAddr = 0x27, uint8_t lcdCols = 16, uint8_t lcdRows = 2);
 
     void begin();
@@ -90,22 +136,26 @@ public:
     // Установка данных
     void setTime(uint8_t h, uint8_t m);
     void setDate(uint8_t d, uint8_t mo, uint16_t y);
-    void setTemperature(float temp);
-    void setHumidity(float hum);
+    void setTemperature(DeciCelsius temp);
+    void setHumidity(DeciPercent hum);
     void setSoilMoisture1(uint8_t moisture);
     void setSoilMoisture2(uint8_t moisture);
-    void setLightLevel(float level);
-    void setWaterVolume(float volume);
-    void setAirQuality(float quality);
+    void setLightLevel(Lux level);
+    void setWaterVolume(Millilitres volume);
+    void setAirQuality(Ppm quality);
+    void setTemperatureTrend(int8_t trend);
+    void setSoilTrend(int8_t trend);
 
     // Установка состояния системы
     void setAutoMode(bool autoMode);
     void setLightState(bool state);
     void setFanState(bool state);
     void setPumpState(bool state);
+    void setFreeMemory(uint16_t bytes);
 
     // Управление ошибками
-    void setError(const String& message);
+    void setError(const char* message);
+    void setError(const __FlashStringHelper* message);
     void clearError();
 
     // Управление дисплеем
@@ -115,8 +165,14 @@ public:
     void setMode(DisplayMode mode);
     void nextMode();
 
-    // Показать сообщение
-    void showMessage(const String& line1, const String& line2 = "", uint16_t duration = 2000);
+    // Показать сообщение (не блокирует). Сообщение с более высоким приоритетом
+    // вытесняет текущее, повторное с тем же текстом продлевает показ
+    void showMessage(const char* line1, const char* line2 = "", uint16_t duration = 2000,
+                     uint8_t priority = PRIORITY_INFO);
+    void showMessage(const __FlashStringHelper* line1, const __FlashStringHelper* line2 = nullptr,
+                     uint16_t duration = 2000, uint8_t priority = PRIORITY_INFO);
+    void clearMessages();
+    bool hasMessage() const { return messageCount > 0; }
 
     // Информация о дисплее
     bool isReady() const { return isInitialized; }
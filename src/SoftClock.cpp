@@ -0,0 +1,191 @@
+#include "SoftClock.h"
+#include "I2cBus.h"
+#include "DS1307RTC.h"
+#include "RtcNvram.h"
+#include "Log.h"
+
+SoftClock::SoftClock()
+{
+    epoch = 0;
+    fraction = 0;
+    ppmRemainder = 0;
+    lastTick = 0;
+    driftPpm = 0;
+    valid = false;
+    state = SYNC_IDLE;
+    edgeSecond = 0;
+    syncStarted = 0;
+    nextSync = 0;
+    failures = 0;
+    lastErrorMs = 0;
+    haveReference = false;
+    referenceEpoch = 0;
+    referenceMillis = 0;
+}
+
+bool SoftClock::begin()
+{
+    loadDrift();
+    lastTick = millis();
+
+    tmElements_t tm;
+    if (!I2cBus::select(I2cBus::DEV_DS1307) || !I2cBus::finish(I2cBus::DEV_DS1307, DS1307RTC::read(tm)))
+    {
+        failSync(lastTick);
+        return false;
+    }
+
+    // Грубая установка, точная - по ближайшему фронту секунды
+    epoch = makeTime(tm);
+    fraction = 0;
+    valid = true;
+    nextSync = lastTick;
+    return true;
+}
+
+void SoftClock::advance(uint32_t deltaMs)
+{
+    // Поправка дрейфа копится в долях 10^-6 мс и переносится целыми миллисекундами
+    ppmRemainder += static_cast<int32_t>(deltaMs) * driftPpm;
+    int32_t correction = ppmRemainder / 1000000L;
+    ppmRemainder -= correction * 1000000L;
+
+    int32_t ms = static_cast<int32_t>(fraction) + static_cast<int32_t>(deltaMs) + correction;
+    if (ms < 0)
+    {
+        ms = 0;
+    }
+    epoch += static_cast<uint32_t>(ms) / 1000UL;
+    fraction = static_cast<uint16_t>(static_cast<uint32_t>(ms) % 1000UL);
+}
+
+void SoftClock::update()
+{
+    uint32_t nowMs = millis();
+    uint32_t delta = nowMs - lastTick;
+    lastTick = nowMs;
+
+    // Длинные паузы дробим, чтобы произведение на ppm не переполнилось
+    while (delta > 100000UL)
+    {
+        advance(100000UL);
+        delta -= 100000UL;
+    }
+    advance(delta);
+
+    if (state == SYNC_IDLE)
+    {
+        if (static_cast<int32_t>(nowMs - nextSync) < 0)
+            return;
+
+        if (!readSeconds(edgeSecond))
+        {
+            failSync(nowMs);
+            return;
+        }
+        syncStarted = nowMs;
+        state = SYNC_WAIT_EDGE;
+        return;
+    }
+
+    uint8_t seconds;
+    if (!readSeconds(seconds))
+    {
+        failSync(nowMs);
+        return;
+    }
+
+    if (seconds == edgeSecond)
+    {
+        if (nowMs - syncStarted > EDGE_TIMEOUT_MS)
+        {
+            failSync(nowMs);
+        }
+        return;
+    }
+
+    // Секунда только что сменилась: время RTC сейчас ровно X.000
+    tmElements_t tm;
+    if (!I2cBus::select(I2cBus::DEV_DS1307) || !I2cBus::finish(I2cBus::DEV_DS1307, DS1307RTC::read(tm)))
+    {
+        failSync(nowMs);
+        return;
+    }
+    completeSync(makeTime(tm), nowMs);
+}
+
+bool SoftClock::readSeconds(uint8_t& seconds)
+{
+    uint8_t value;
+    if (!I2cBus::readRegisters(I2cBus::DEV_DS1307, 0x00, &value, 1, false))
+        return false;
+    if (value & 0x80)
+        return false;  // бит CH: генератор RTC остановлен
+    seconds = value;
+    return true;
+}
+
+void SoftClock::completeSync(uint32_t rtcEpoch, uint32_t nowMs)
+{
+    int32_t error = static_cast<int32_t>(rtcEpoch - epoch) * 1000L - fraction;
+    lastErrorMs = error;
+
+    if (!haveReference || nowMs - referenceMillis > MAX_DRIFT_WINDOW_MS)
+    {
+        haveReference = true;
+        referenceEpoch = rtcEpoch;
+        referenceMillis = nowMs;
+    }
+    else if (nowMs - referenceMillis >= MIN_DRIFT_WINDOW_MS)
+    {
+        // Дрейф по всему окну: чем оно длиннее, тем точнее оценка
+        int64_t rawMs = static_cast<int64_t>(nowMs - referenceMillis);
+        int64_t rtcMs = static_cast<int64_t>(rtcEpoch - referenceEpoch) * 1000;
+        int64_t ppm = (rtcMs - rawMs) * 1000000 / rawMs;
+        driftPpm = static_cast<int16_t>(constrain(ppm, -MAX_DRIFT_PPM, MAX_DRIFT_PPM));
+        saveDrift();
+        LOG_DEBUG(SENSORS, EV_RTC_DRIFT, "Clock drift, ppm", driftPpm);
+    }
+
+    epoch = rtcEpoch;
+    fraction = 0;
+    ppmRemainder = 0;
+    valid = true;
+    failures = 0;
+    state = SYNC_IDLE;
+    nextSync = nowMs + SYNC_INTERVAL_MS;
+
+    LOG_DEBUG(SENSORS, EV_RTC_SYNC, "Clock synced, error ms", static_cast<int16_t>(constrain(error, -32768L, 32767L)));
+}
+
+void SoftClock::failSync(uint32_t nowMs)
+{
+    if (failures < UINT16_MAX)
+        failures++;
+    state = SYNC_IDLE;
+    nextSync = nowMs + RETRY_INTERVAL_MS;
+    LOG_WARN(SENSORS, EV_RTC_READ_FAIL, "RTC sync failed", failures);
+}
+
+void SoftClock::loadDrift()
+{
+    uint8_t data[4];
+    if (!RtcNvram::read(RtcNvram::CLOCK_DRIFT_OFFSET, data, sizeof(data)))
+        return;
+    if (data[0] != DRIFT_MAGIC || static_cast<uint8_t>(data[0] ^ data[1] ^ data[2]) != data[3])
+        return;
+
+    int16_t ppm = static_cast<int16_t>(data[1] | (data[2] << 8));
+    if (ppm >= -MAX_DRIFT_PPM && ppm <= MAX_DRIFT_PPM)
+        driftPpm = ppm;
+}
+
+void SoftClock::saveDrift()
+{
+    uint8_t data[4];
+    data[0] = DRIFT_MAGIC;
+    data[1] = static_cast<uint8_t>(driftPpm);
+    data[2] = static_cast<uint8_t>(driftPpm >> 8);
+    data[3] = data[0] ^ data[1] ^ data[2];
+    RtcNvram::write(RtcNvram::CLOCK_DRIFT_OFFSET, data, sizeof(data));
+}
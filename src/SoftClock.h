@@ -0,0 +1,79 @@
+#ifndef SOFT_CLOCK_H
+#define SOFT_CLOCK_H
+
+#include <Arduino.h>
+#include <TimeLib.h>
+
+// Календарные часы на millis(), подстраиваемые по DS1307.
+// Синхронизация раз в SYNC_INTERVAL_MS по фронту секунды RTC: ждем смены
+// регистра секунд (1 байт по I2C за вызов update), затем читаем время целиком.
+// Расхождение millis() с RTC копится с первой синхронизации и дает оценку
+// дрейфа в ppm, которая применяется между синхронизациями и хранится в NVRAM.
+// При ошибке часы продолжают идти, синхронизация повторяется через RETRY_INTERVAL_MS.
+class SoftClock
+{
+public:
+    static const uint32_t SYNC_INTERVAL_MS = 3600000UL;
+    static const uint32_t RETRY_INTERVAL_MS = 60000UL;
+    static const uint16_t EDGE_TIMEOUT_MS = 1500;        // секунда RTC не сменилась - часы стоят
+    static const uint32_t MIN_DRIFT_WINDOW_MS = 3600000UL;
+    static const uint32_t MAX_DRIFT_WINDOW_MS = 7UL * 24UL * 3600000UL;
+    static const int16_t MAX_DRIFT_PPM = 10000;          // керамический резонатор Uno - до 0.5 %
+
+private:
+    enum SyncState : uint8_t
+    {
+        SYNC_IDLE,
+        SYNC_WAIT_EDGE
+    };
+
+    static const uint8_t DRIFT_MAGIC = 0xC1;
+
+    uint32_t epoch;        // целые секунды
+    uint16_t fraction;     // миллисекунды внутри секунды
+    int32_t ppmRemainder;  // накопленная поправка дрейфа, мс * 10^6
+    uint32_t lastTick;
+
+    int16_t driftPpm;
+    bool valid;
+
+    SyncState state;
+    uint8_t edgeSecond;
+    uint32_t syncStarted;
+    uint32_t nextSync;
+    uint16_t failures;
+    int32_t lastErrorMs;
+
+    // Начало окна оценки дрейфа
+    bool haveReference;
+    uint32_t referenceEpoch;
+    uint32_t referenceMillis;
+
+    void advance(uint32_t deltaMs);
+    bool readSeconds(uint8_t& seconds);
+    void completeSync(uint32_t rtcEpoch, uint32_t nowMs);
+    void failSync(uint32_t nowMs);
+    void loadDrift();
+    void saveDrift();
+
+public:
+    SoftClock();
+
+    // Первое чтение RTC (блокирующее, только при старте)
+    bool begin();
+
+    // Часто: ход часов и шаги синхронизации
+    void update();
+
+    void requestSync() { nextSync = millis(); }
+
+    uint32_t now() const { return epoch; }
+    bool isValid() const { return valid; }
+    // Первая синхронизация по фронту секунды прошла или не удалась: дальше время на старте не скачет
+    bool isSettled() const { return haveReference || failures > 0; }
+    int16_t getDriftPpm() const { return driftPpm; }
+    uint16_t getFailures() const { return failures; }
+    int32_t getLastErrorMs() const { return lastErrorMs; }
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "TaskProfiler.h"
+
+#ifdef TASK_PROFILING
+
+TaskProfiler::TaskProfiler()
+{
+    for (uint8_t i = 0; i < MAX_SLOTS; i++)
+    {
+        slots[i].name = nullptr;
+    }
+    reset();
+}
+
+void TaskProfiler::setName(uint8_t slot, const __FlashStringHelper* name)
+{
+    if (slot < MAX_SLOTS)
+    {
+        slots[slot].name = name;
+    }
+}
+
+void TaskProfiler::record(uint8_t slot, uint32_t us)
+{
+    if (slot >= MAX_SLOTS)
+        return;
+
+    Slot& s = slots[slot];
+
+    // При переполнении суммы делим ее вместе со счетчиком: среднее сохраняется
+    if (s.totalUs + us < s.totalUs)
+    {
+        s.totalUs >>= 1;
+        s.runs >>= 1;
+    }
+    s.totalUs += us;
+    s.runs++;
+
+    if (us < s.minUs)
+        s.minUs = us;
+    if (us > s.maxUs)
+        s.maxUs = us;
+
+    uint8_t bucket = 0;
+    uint32_t scaled = us >> FIRST_BUCKET_SHIFT;
+    while (scaled != 0 && bucket < BUCKETS - 1)
+    {
+        scaled >>= BUCKET_SHIFT;
+        bucket++;
+    }
+
+    // Насыщение корзины - делим всю гистограмму пополам, форма распределения сохраняется
+    if (s.histogram[bucket] == UINT16_MAX)
+    {
+        for (uint8_t i = 0; i < BUCKETS; i++)
+        {
+            s.histogram[i] >>= 1;
+        }
+    }
+    s.histogram[bucket]++;
+}
+
+void TaskProfiler::recordOverrun(uint8_t slot)
+{
+    if (slot < MAX_SLOTS && slots[slot].overruns < UINT16_MAX)
+    {
+        slots[slot].overruns++;
+    }
+}
+
+void TaskProfiler::reset()
+{
+    for (uint8_t i = 0; i < MAX_SLOTS; i++)
+    {
+        Slot& s = slots[i];
+        s.runs = 0;
+        s.totalUs = 0;
+        s.minUs = UINT32_MAX;
+        s.maxUs = 0;
+        s.overruns = 0;
+        memset(s.histogram, 0, sizeof(s.histogram));
+    }
+}
+
+void TaskProfiler::dumpHeader(Print& out) const
+{
+    out.println(F("task        runs   min   avg    max late |   <64  <256   <1k   <4k  <16k  <64k <256k >256k"));
+}
+
+void TaskProfiler::dumpSlot(Print& out, uint8_t slot) const
+{
+    if (slot >= MAX_SLOTS)
+        return;
+
+    const Slot& s = slots[slot];
+
+    if (s.name != nullptr)
+    {
+        uint8_t len = out.print(s.name);
+        for (; len < 8; len++)
+            out.write(' ');
+    }
+    else
+    {
+        out.print(F("task "));
+        printPadded(out, slot, 3);
+    }
+
+    printPadded(out, s.runs, 8);
+    printPadded(out, s.runs ? s.minUs : 0, 6);
+    printPadded(out, s.runs ? s.totalUs / s.runs : 0, 6);
+    printPadded(out, s.maxUs, 7);
+    printPadded(out, s.overruns, 5);
+    out.print(F(" |"));
+    for (uint8_t b = 0; b < BUCKETS; b++)
+    {
+        printPadded(out, s.histogram[b], 6);
+    }
+    out.println();
+}
+
+void TaskProfiler::printPadded(Print& out, uint32_t value, uint8_t width)
+{
+    uint8_t digits = 1;
+    for (uint32_t v = value; v >= 10; v /= 10)
+        digits++;
+
+    for (; digits < width; digits++)
+        out.write(' ');
+    out.print(value);
+}
+
+#endif
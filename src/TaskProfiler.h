@@ -0,0 +1,52 @@
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+// Профилирование задач планировщика. Включается флагом сборки -DTASK_PROFILING,
+// без него класс не компилируется и не занимает ни RAM, ни флеш.
+#ifdef TASK_PROFILING
+
+#include <Arduino.h>
+
+// Статистика времени выполнения по слотам (задача или проход loop):
+// min/max/среднее и гистограмма с шагом x4 от 64 мкс.
+class TaskProfiler
+{
+public:
+    static const uint8_t MAX_SLOTS = 13;
+    static const uint8_t BUCKETS = 8;            // <64, <256, <1k ... >=256k мкс
+    static const uint8_t FIRST_BUCKET_SHIFT = 6; // граница первой корзины 2^6 мкс
+    static const uint8_t BUCKET_SHIFT = 2;       // каждая следующая в 4 раза шире
+
+private:
+    struct Slot
+    {
+        const __FlashStringHelper* name;
+        uint32_t runs;
+        uint32_t totalUs;
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint16_t overruns;
+        uint16_t histogram[BUCKETS];
+    };
+
+    Slot slots[MAX_SLOTS];
+
+    static void printPadded(Print& out, uint32_t value, uint8_t width);
+
+public:
+    TaskProfiler();
+
+    void setName(uint8_t slot, const __FlashStringHelper* name);
+
+    void record(uint8_t slot, uint32_t us);
+    void recordOverrun(uint8_t slot);
+    void reset();
+
+    // Таблица: заголовок и по строке на слот
+    void dumpHeader(Print& out) const;
+    void dumpSlot(Print& out, uint8_t slot) const;
+};
+
+#endif
+
+#endif
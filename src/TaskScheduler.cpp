@@ -0,0 +1,150 @@
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler() : taskCount(0)
+{
+    memset(tasks, 0, sizeof(tasks));
+#ifdef TASK_PROFILING
+    loopBudgetUs = UINT32_MAX;
+    profiler.setName(LOOP_SLOT, F("loop"));
+#endif
+}
+
+int8_t TaskScheduler::addTask(TaskCallback callback, uint32_t period, uint32_t phase, uint32_t deadline)
+{
+    if (callback == nullptr || taskCount >= MAX_TASKS)
+    {
+        return INVALID_TASK;
+    }
+
+    Task &task = tasks[taskCount];
+    task.callback = callback;
+    task.period = period;
+    task.nextRun = millis() + phase;
+    task.deadline = deadline;
+    task.overruns = 0;
+    task.enabled = true;
+
+#ifdef TASK_PROFILING
+    if (period * 1000UL < loopBudgetUs)
+    {
+        loopBudgetUs = period * 1000UL;
+    }
+#endif
+
+    return static_cast<int8_t>(taskCount++);
+}
+
+void TaskScheduler::setEnabled(int8_t id, bool enabled)
+{
+    if (id < 0 || id >= taskCount)
+        return;
+
+    if (enabled && !tasks[id].enabled)
+    {
+        tasks[id].nextRun = millis();
+    }
+    tasks[id].enabled = enabled;
+}
+
+void TaskScheduler::setPeriod(int8_t id, uint32_t period)
+{
+    if (id < 0 || id >= taskCount)
+        return;
+
+    tasks[id].period = period;
+}
+
+void TaskScheduler::trigger(int8_t id)
+{
+    if (id < 0 || id >= taskCount)
+        return;
+
+    tasks[id].nextRun = millis();
+}
+
+void TaskScheduler::run()
+{
+#ifdef TASK_PROFILING
+    uint32_t passStart = micros();
+    bool busy = false;
+#endif
+
+    // Порядок в таблице задает приоритет: задачи выполняются по очереди
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        Task &task = tasks[i];
+        if (!task.enabled)
+            continue;
+
+        uint32_t now = millis();
+        if (!isDue(now, task.nextRun))
+            continue;
+
+        uint32_t lateness = now - task.nextRun;
+        if (task.deadline != 0 && lateness > task.deadline)
+        {
+            if (task.overruns < UINT16_MAX)
+                task.overruns++;
+#ifdef TASK_PROFILING
+            profiler.recordOverrun(i);
+#endif
+        }
+
+        // Сохраняем фазу, но не догоняем пропущенные запуски пачкой
+        task.nextRun += task.period;
+        if (isDue(now, task.nextRun))
+        {
+            task.nextRun = now + task.period;
+        }
+
+#ifdef TASK_PROFILING
+        uint32_t started = micros();
+        task.callback();
+        profiler.record(i, micros() - started);
+        busy = true;
+#else
+        task.callback();
+#endif
+    }
+
+#ifdef TASK_PROFILING
+    // Пустые проходы не учитываем: они только размывают статистику
+    if (busy)
+    {
+        uint32_t passUs = micros() - passStart;
+        profiler.record(LOOP_SLOT, passUs);
+        if (passUs > loopBudgetUs)
+        {
+            profiler.recordOverrun(LOOP_SLOT);
+        }
+    }
+#endif
+}
+
+uint16_t TaskScheduler::getOverruns(int8_t id) const
+{
+    if (id < 0 || id >= taskCount)
+        return 0;
+
+    return tasks[id].overruns;
+}
+
+#ifdef TASK_PROFILING
+void TaskScheduler::setName(int8_t id, const __FlashStringHelper* name)
+{
+    if (id < 0 || id >= taskCount)
+        return;
+
+    profiler.setName(id, name);
+}
+
+void TaskScheduler::dumpProfile(Print& out) const
+{
+    profiler.dumpHeader(out);
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        profiler.dumpSlot(out, i);
+    }
+    profiler.dumpSlot(out, LOOP_SLOT);
+}
+#endif
@@ -0,0 +1,75 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include "TaskProfiler.h"
+
+// Кооперативный планировщик задач со статической таблицей.
+// Задачи не должны блокировать: каждая делает короткий шаг и возвращается.
+class TaskScheduler
+{
+public:
+    typedef void (*TaskCallback)();
+
+    static const uint8_t MAX_TASKS = 12;
+    static const int8_t INVALID_TASK = -1;
+
+private:
+    struct Task
+    {
+        TaskCallback callback;
+        uint32_t period;    // мс между запусками
+        uint32_t nextRun;   // момент следующего запуска (millis)
+        uint32_t deadline;  // допустимое опоздание, 0 - без контроля
+        uint16_t overruns;  // сколько раз опоздали больше deadline
+        bool enabled;
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t taskCount;
+
+#ifdef TASK_PROFILING
+    // Последний слот профилировщика - проход run() целиком
+    static const uint8_t LOOP_SLOT = MAX_TASKS;
+    static_assert(LOOP_SLOT < TaskProfiler::MAX_SLOTS, "profiler needs a slot per task plus one for the loop");
+
+    TaskProfiler profiler;
+    uint32_t loopBudgetUs; // проход дольше самого короткого периода = чья-то задача опоздала
+#endif
+
+    // Сравнение с учетом переполнения millis()
+    static bool isDue(uint32_t now, uint32_t when) { return static_cast<int32_t>(now - when) >= 0; }
+
+public:
+    TaskScheduler();
+
+    // Регистрация задачи: period - период, phase - сдвиг первого запуска,
+    // deadline - допустимое опоздание. Возвращает id задачи или INVALID_TASK.
+    int8_t addTask(TaskCallback callback, uint32_t period, uint32_t phase = 0, uint32_t deadline = 0);
+
+    void setEnabled(int8_t id, bool enabled);
+    void setPeriod(int8_t id, uint32_t period);
+    // Запустить задачу на ближайшем проходе
+    void trigger(int8_t id);
+
+    // Один проход по таблице: выполняет все задачи, срок которых наступил
+    void run();
+
+    uint16_t getOverruns(int8_t id) const;
+    uint8_t getTaskCount() const { return taskCount; }
+
+#ifdef TASK_PROFILING
+    void setName(int8_t id, const __FlashStringHelper* name);
+    void dumpProfile(Print& out) const;
+    void resetProfile() { profiler.reset(); }
+#endif
+};
+
+// Имя задачи для отчета профилировщика; без TASK_PROFILING строка не попадает во флеш
+#ifdef TASK_PROFILING
+#define TASK_NAME(scheduler, id, name) (scheduler).setName((id), F(name))
+#else
+#define TASK_NAME(scheduler, id, name) ((void)(id))
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+#include "Telemetry.h"
+
+Telemetry::Telemetry(HardwareSerial& port) : port(port)
+{
+    head = 0;
+    tail = 0;
+    sequence = 0;
+    droppedFrames = 0;
+}
+
+void Telemetry::put(uint8_t data)
+{
+    buffer[head] = data;
+    head = (head + 1) & (BUFFER_SIZE - 1);
+}
+
+bool Telemetry::sendFrame(uint8_t type, const uint8_t* payload, uint8_t len)
+{
+    uint8_t frameSize = TelemetryFrame::HEADER_SIZE + len + TelemetryFrame::CRC_SIZE;
+
+    // Одна ячейка кольца всегда пустая, чтобы отличать полный буфер от пустого
+    if (len > TelemetryFrame::MAX_PAYLOAD || frameSize > BUFFER_SIZE - 1 - used())
+    {
+        if (droppedFrames < UINT16_MAX)
+            droppedFrames++;
+        sequence++;  // пропуск номера покажет потерю на стороне приемника
+        return false;
+    }
+
+    put(TelemetryFrame::SYNC_1);
+    put(TelemetryFrame::SYNC_2);
+
+    uint16_t crc = 0xFFFF;
+    uint8_t header[3] = {len, type, sequence++};
+    for (uint8_t i = 0; i < sizeof(header); i++)
+    {
+        put(header[i]);
+        crc = TelemetryFrame::crc16Update(crc, header[i]);
+    }
+    for (uint8_t i = 0; i < len; i++)
+    {
+        put(payload[i]);
+        crc = TelemetryFrame::crc16Update(crc, payload[i]);
+    }
+
+    put(static_cast<uint8_t>(crc));
+    put(static_cast<uint8_t>(crc >> 8));
+    return true;
+}
+
+bool Telemetry::sendReadings(const TelemetryRecord& record)
+{
+    uint8_t payload[TelemetryFrame::READINGS_SIZE];
+    TelemetryFrame::encodeReadings(record, payload);
+    return sendFrame(TelemetryFrame::TYPE_READINGS, payload, sizeof(payload));
+}
+
+void Telemetry::pump()
+{
+    // Кадры уходят в UART только целиком: строки журнала, которые пишутся в тот же
+    // порт, могут встать между кадрами, но не внутрь кадра
+    int room = port.availableForWrite();
+    while (tail != head)
+    {
+        uint8_t frameSize = buffer[(tail + 2) & (BUFFER_SIZE - 1)] + TelemetryFrame::HEADER_SIZE + TelemetryFrame::CRC_SIZE;
+        if (room < frameSize)
+            break;
+
+        for (uint8_t i = 0; i < frameSize; i++)
+        {
+            port.write(buffer[tail]);
+            tail = (tail + 1) & (BUFFER_SIZE - 1);
+        }
+        room -= frameSize;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "TelemetryFrame.h"
+
+// Отправка кадров телеметрии без блокировки: кадр целиком кладется в кольцевой
+// буфер, pump() отдает в UART те кадры, что целиком влезают в его буфер.
+// Если места под кадр нет, кадр отбрасывается целиком и учитывается в счетчике.
+class Telemetry
+{
+public:
+    static const uint8_t BUFFER_SIZE = 128;  // степень двойки
+
+private:
+    HardwareSerial& port;
+    uint8_t buffer[BUFFER_SIZE];
+    uint8_t head;  // сюда пишем
+    uint8_t tail;  // отсюда отправляем
+    uint8_t sequence;
+    uint16_t droppedFrames;
+
+    uint8_t used() const { return static_cast<uint8_t>(head - tail) & (BUFFER_SIZE - 1); }
+    void put(uint8_t data);
+
+public:
+    explicit Telemetry(HardwareSerial& port);
+
+    bool sendFrame(uint8_t type, const uint8_t* payload, uint8_t len);
+    bool sendReadings(const TelemetryRecord& record);
+
+    // Вызывать часто: переносит кадры из кольца в UART, не дожидаясь линии
+    void pump();
+
+    uint16_t getDroppedFrames() const { return droppedFrames; }
+};
+
+#endif
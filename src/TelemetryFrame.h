@@ -0,0 +1,147 @@
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stdint.h>
+
+// Формат двоичной телеметрии. Общий для прошивки и декодера на хосте
+// (tools/telemetry_decode.cpp), поэтому без зависимостей от Arduino.
+//
+// Кадр: | 0xA5 | 0x5A | len | type | seq | payload[len] | crc16 (LE) |
+// CRC-16/CCITT-FALSE считается по len, type, seq и payload.
+// Все многобайтовые поля - little endian.
+
+// Одна запись на цикл опроса датчиков (TYPE_READINGS)
+struct TelemetryRecord
+{
+    uint32_t timeMs;
+    uint32_t lightLux;
+    int16_t airTempDeci;    // 0.1 °C
+    uint16_t airHumDeci;    // 0.1 %
+    uint16_t eco2Ppm;
+    uint16_t tvocPpb;
+    uint8_t aqi;
+    uint16_t waterDistMm;
+    uint32_t waterVolumeMl;
+    uint8_t soil1;          // %
+    uint8_t soil2;          // %
+    uint8_t hour, minute, second;
+    uint8_t day, month;
+    uint16_t year;
+    uint8_t sensorFlags;    // SENSOR_*_OK
+    uint8_t actuatorFlags;  // ACTUATOR_*
+};
+
+class TelemetryFrame
+{
+public:
+    static const uint8_t SYNC_1 = 0xA5;
+    static const uint8_t SYNC_2 = 0x5A;
+    static const uint8_t HEADER_SIZE = 5;  // sync x2, len, type, seq
+    static const uint8_t CRC_SIZE = 2;
+    static const uint8_t MAX_PAYLOAD = 48;
+
+    // Тип несет и версию раскладки: при изменении записи - новый тип
+    static const uint8_t TYPE_READINGS = 0x01;
+    static const uint8_t READINGS_SIZE = 34;
+
+    static const uint8_t SENSOR_LIGHT_OK = 0x01;
+    static const uint8_t SENSOR_AIR_TEMP_OK = 0x02;
+    static const uint8_t SENSOR_AIR_QUAL_OK = 0x04;
+    static const uint8_t SENSOR_SOIL_1_OK = 0x08;
+    static const uint8_t SENSOR_SOIL_2_OK = 0x10;
+    static const uint8_t SENSOR_RTC_OK = 0x20;
+    static const uint8_t SENSOR_WATER_OK = 0x40;
+
+    static const uint8_t ACTUATOR_LIGHT = 0x01;
+    static const uint8_t ACTUATOR_FAN = 0x02;
+    static const uint8_t ACTUATOR_PUMP = 0x04;
+    static const uint8_t ACTUATOR_AUTO_MODE = 0x08;
+
+    static uint16_t crc16Update(uint16_t crc, uint8_t data)
+    {
+        crc ^= static_cast<uint16_t>(data) << 8;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+        return crc;
+    }
+
+    // out должен вмещать READINGS_SIZE байт
+    static void encodeReadings(const TelemetryRecord& r, uint8_t* out)
+    {
+        uint8_t* p = out;
+        put32(p, r.timeMs);
+        put32(p, r.lightLux);
+        put16(p, static_cast<uint16_t>(r.airTempDeci));
+        put16(p, r.airHumDeci);
+        put16(p, r.eco2Ppm);
+        put16(p, r.tvocPpb);
+        *p++ = r.aqi;
+        put16(p, r.waterDistMm);
+        put32(p, r.waterVolumeMl);
+        *p++ = r.soil1;
+        *p++ = r.soil2;
+        *p++ = r.hour;
+        *p++ = r.minute;
+        *p++ = r.second;
+        *p++ = r.day;
+        *p++ = r.month;
+        put16(p, r.year);
+        *p++ = r.sensorFlags;
+        *p++ = r.actuatorFlags;
+    }
+
+    static void decodeReadings(const uint8_t* in, TelemetryRecord& r)
+    {
+        const uint8_t* p = in;
+        r.timeMs = get32(p);
+        r.lightLux = get32(p);
+        r.airTempDeci = static_cast<int16_t>(get16(p));
+        r.airHumDeci = get16(p);
+        r.eco2Ppm = get16(p);
+        r.tvocPpb = get16(p);
+        r.aqi = *p++;
+        r.waterDistMm = get16(p);
+        r.waterVolumeMl = get32(p);
+        r.soil1 = *p++;
+        r.soil2 = *p++;
+        r.hour = *p++;
+        r.minute = *p++;
+        r.second = *p++;
+        r.day = *p++;
+        r.month = *p++;
+        r.year = get16(p);
+        r.sensorFlags = *p++;
+        r.actuatorFlags = *p++;
+    }
+
+private:
+    static void put16(uint8_t*& p, uint16_t v)
+    {
+        *p++ = static_cast<uint8_t>(v);
+        *p++ = static_cast<uint8_t>(v >> 8);
+    }
+
+    static void put32(uint8_t*& p, uint32_t v)
+    {
+        put16(p, static_cast<uint16_t>(v));
+        put16(p, static_cast<uint16_t>(v >> 16));
+    }
+
+    static uint16_t get16(const uint8_t*& p)
+    {
+        uint16_t v = static_cast<uint16_t>(p[0] | (p[1] << 8));
+        p += 2;
+        return v;
+    }
+
+    static uint32_t get32(const uint8_t*& p)
+    {
+        uint32_t lo = get16(p);
+        uint32_t hi = get16(p);
+        return lo | (hi << 16);
+    }
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "UltrasonicAsync.h"
+
+volatile uint8_t* UltrasonicAsync::echoPort = nullptr;
+uint8_t UltrasonicAsync::echoMask = 0;
+volatile uint32_t UltrasonicAsync::echoStart = 0;
+volatile uint32_t UltrasonicAsync::echoWidth = 0;
+volatile uint8_t UltrasonicAsync::echoFlag = ECHO_NONE;
+
+ISR(PCINT0_vect)
+{
+    UltrasonicAsync::handleInterrupt();
+}
+
+UltrasonicAsync::UltrasonicAsync(uint8_t trigPin, uint8_t echoPin) : trigPin(trigPin), echoPin(echoPin)
+{
+    state = STATE_IDLE;
+    pingTime = 0;
+    triggerMicros = 0;
+    memset(samples, 0, sizeof(samples));
+    sampleIndex = 0;
+    sampleCount = 0;
+    filteredMm = 0;
+    missedEchoes = 0;
+    echoCount = 0;
+}
+
+void UltrasonicAsync::begin()
+{
+    pinMode(trigPin, OUTPUT);
+    pinMode(echoPin, INPUT);
+    digitalWrite(trigPin, LOW);
+
+    echoPort = portInputRegister(digitalPinToPort(echoPin));
+    echoMask = digitalPinToBitMask(echoPin);
+
+    // Прерывание по изменению уровня на ECHO
+    *digitalPinToPCMSK(echoPin) |= _BV(digitalPinToPCMSKbit(echoPin));
+    *digitalPinToPCICR(echoPin) |= _BV(digitalPinToPCICRbit(echoPin));
+
+    state = STATE_IDLE;
+}
+
+void UltrasonicAsync::handleInterrupt()
+{
+    if (echoPort == nullptr)
+        return;
+
+    uint32_t now = micros();
+    if (*echoPort & echoMask)
+    {
+        echoStart = now;
+        echoFlag = ECHO_HIGH;
+    }
+    else if (echoFlag == ECHO_HIGH)
+    {
+        echoWidth = now - echoStart;
+        echoFlag = ECHO_DONE;
+    }
+}
+
+void UltrasonicAsync::update()
+{
+    if (state == STATE_IDLE)
+    {
+        if (millis() - pingTime >= PING_INTERVAL_MS)
+        {
+            ping();
+        }
+        return;
+    }
+
+    noInterrupts();
+    uint8_t flag = echoFlag;
+    uint32_t width = echoWidth;
+    interrupts();
+
+    if (flag == ECHO_DONE)
+    {
+        state = STATE_IDLE;
+        if (width < ECHO_TIMEOUT_US)
+        {
+            // Скорость звука: 58 мкс на сантиметр туда-обратно
+            addSample(static_cast<uint16_t>((width * 10UL + 29UL) / 58UL));
+        }
+        else
+        {
+            missedEchoes++;
+        }
+    }
+    else if (micros() - triggerMicros > ECHO_TIMEOUT_US + 1000UL)
+    {
+        state = STATE_IDLE;
+        missedEchoes++;
+    }
+}
+
+void UltrasonicAsync::ping()
+{
+    noInterrupts();
+    echoFlag = ECHO_NONE;
+    interrupts();
+
+    // Импульс 10 мкс - единственное активное ожидание
+    digitalWrite(trigPin, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(trigPin, LOW);
+
+    pingTime = millis();
+    triggerMicros = micros();
+    state = STATE_WAIT_ECHO;
+}
+
+void UltrasonicAsync::addSample(uint16_t mm)
+{
+    echoCount++;
+    samples[sampleIndex] = mm;
+    sampleIndex = (sampleIndex + 1) % MEDIAN_WINDOW;
+    if (sampleCount < MEDIAN_WINDOW)
+    {
+        sampleCount++;
+    }
+    filteredMm = median();
+}
+
+uint16_t UltrasonicAsync::median() const
+{
+    // Сортировка вставками копии окна, окно маленькое
+    uint16_t sorted[MEDIAN_WINDOW];
+    for (uint8_t i = 0; i < sampleCount; i++)
+    {
+        uint16_t value = samples[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > value)
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    return sorted[sampleCount / 2];
+}
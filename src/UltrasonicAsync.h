@@ -0,0 +1,73 @@
+#ifndef ULTRASONIC_ASYNC_H
+#define ULTRASONIC_ASYNC_H
+
+#include <Arduino.h>
+
+// Неблокирующий HC-SR04: импульс запуска, фронты эха ловятся прерыванием
+// по изменению уровня (PCINT), результат фильтруется медианой по N замерам.
+// Используется вектор PCINT0, поэтому ECHO должен быть на D8..D13.
+// Поддерживается один экземпляр.
+class UltrasonicAsync
+{
+public:
+    static const uint8_t MEDIAN_WINDOW = 5;
+    static const uint16_t PING_INTERVAL_MS = 60;   // минимальная пауза между замерами по даташиту
+    static const uint16_t ECHO_TIMEOUT_US = 30000; // ~5 м, дальше считаем, что эха нет
+
+private:
+    enum State : uint8_t
+    {
+        STATE_IDLE,
+        STATE_WAIT_ECHO
+    };
+
+    enum EchoFlag : uint8_t
+    {
+        ECHO_NONE,
+        ECHO_HIGH,
+        ECHO_DONE
+    };
+
+    uint8_t trigPin;
+    uint8_t echoPin;
+
+    State state;
+    uint32_t pingTime;       // millis() последнего запуска
+    uint32_t triggerMicros;  // micros() последнего запуска
+
+    uint16_t samples[MEDIAN_WINDOW]; // расстояния в мм
+    uint8_t sampleIndex;
+    uint8_t sampleCount;
+    uint16_t filteredMm;
+    uint16_t missedEchoes;
+    uint16_t echoCount;  // с переполнением, для проверки свежести
+
+    // Общие с обработчиком прерывания
+    static volatile uint8_t* echoPort;
+    static uint8_t echoMask;
+    static volatile uint32_t echoStart;
+    static volatile uint32_t echoWidth;
+    static volatile uint8_t echoFlag;
+
+    void ping();
+    void addSample(uint16_t mm);
+    uint16_t median() const;
+
+public:
+    UltrasonicAsync(uint8_t trigPin, uint8_t echoPin);
+
+    void begin();
+
+    // Шаг автомата: вызывать часто, не блокирует
+    void update();
+
+    bool hasReading() const { return sampleCount > 0; }
+    uint16_t getDistanceMm() const { return filteredMm; }
+    uint16_t getMissedEchoes() const { return missedEchoes; }
+    uint16_t getEchoCount() const { return echoCount; }
+
+    // Вызывается из ISR(PCINT0_vect)
+    static void handleInterrupt();
+};
+
+#endif
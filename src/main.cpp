@@ -5,68 +5,365 @@ SensorManager sensors;
 DeviceManager devices(LIGHT_PIN, FAN_PIN, PUMP_PIN);
 GreenhouseDisplay display(0x27, 16, 2);
 
+TaskScheduler scheduler;
+Telemetry telemetry(Serial);
+SensorHistory history;
+EepromLog eepromLog;
+FanController fanController(FAN_CONFIG);
+RuleEngine rules;
+Irrigation irrigation(devices, IRRIGATION_CONFIG);
+PumpCalibrator pumpCalibrator(devices, PUMP_CALIBRATION);
+DailyLight dailyLight(DAILY_LIGHT_CONFIG);
+
 bool systemAutoMode = true;
+bool rulesFanOn = false;  // правило требует полной скорости поверх регулятора
+bool rulesLightOn = false;
+uint8_t shownSensorFaults = 0;  // отказавшие датчики, о которых сообщает дисплей
+
+// Размеры глобальных объектов для 'm': считает компилятор, в RAM только код вывода
+static const char objSensors[] PROGMEM = "sensors";
+static const char objDevices[] PROGMEM = "devices";
+static const char objDisplay[] PROGMEM = "display";
+static const char objScheduler[] PROGMEM = "scheduler";
+static const char objTelemetry[] PROGMEM = "telemetry";
+static const char objHistory[] PROGMEM = "history";
+static const char objEepromLog[] PROGMEM = "eepromLog";
+static const char objFan[] PROGMEM = "fan";
+static const char objRules[] PROGMEM = "rules";
+static const char objIrrigation[] PROGMEM = "irrigation";
+static const char objPump[] PROGMEM = "pumpCalibrator";
+static const char objDailyLight[] PROGMEM = "dailyLight";
+static const char objSerial[] PROGMEM = "Serial";
+static const char objWire[] PROGMEM = "Wire";
+static const char objTrace[] PROGMEM = "logTrace";
+#ifdef __AVR__
+// Буферы Wire (прием, передача) и twi.c (три) статические и в sizeof(Wire) не входят
+static const uint16_t WIRE_RAM = sizeof(Wire) + 5 * BUFFER_LENGTH;
+#else
+static const uint16_t WIRE_RAM = sizeof(Wire);
+#endif
+static const MemoryMonitor::ObjectSize RAM_OBJECTS[] PROGMEM = {
+    {objSensors, sizeof(sensors)},
+    {objDevices, sizeof(devices)},
+    {objDisplay, sizeof(display)},
+    {objScheduler, sizeof(scheduler)},
+    {objTelemetry, sizeof(telemetry)},
+    {objHistory, sizeof(history)},
+    {objEepromLog, sizeof(eepromLog)},
+    {objFan, sizeof(fanController)},
+    {objRules, sizeof(rules)},
+    {objIrrigation, sizeof(irrigation)},
+    {objPump, sizeof(pumpCalibrator)},
+    {objDailyLight, sizeof(dailyLight)},
+    {objSerial, sizeof(Serial)},
+    {objWire, WIRE_RAM},
+    {objTrace, Log::TRACE_BYTES},
+};
+
+static const char alertWater1[] PROGMEM = "WATER";
+static const char alertWater2[] PROGMEM = "NOW";
+static const char alertRefill1[] PROGMEM = "REFILL";
+static const char alertRefill2[] PROGMEM = "TANK";
+static const char* const alertLines[ALERT_COUNT][2] PROGMEM = {
+    {alertWater1, alertWater2},
+    {alertRefill1, alertRefill2},
+};
 
 void runAutoMode();
+void updateLighting();
+void sendTelemetry();
+
+// Задачи планировщика
+void devicesTask() {
+    devices.update();
+    eepromLog.update();
+    rules.update();
+}
+
+void sensorsPollTask() {
+    sensors.poll();
+}
+
+void sensorsTask() {
+    sensors.update_all();
+    updateLighting();
+    updateDisplayWithSensorData();
+    sendTelemetry();
+}
+
+void historyTask() {
+    int32_t values[SensorHistory::CHANNEL_COUNT];
+    values[SensorHistory::CH_TEMPERATURE] = sensors.get_air_temp().getRaw();
+    values[SensorHistory::CH_HUMIDITY] = sensors.get_air_humidity().getRaw();
+    values[SensorHistory::CH_CO2] = sensors.get_air_CO2().getRaw();
+    values[SensorHistory::CH_LIGHT] = sensors.get_light_level().getRaw();
+    values[SensorHistory::CH_SOIL_1] = sensors.get_soil_moisture_1();
+    values[SensorHistory::CH_SOIL_2] = sensors.get_soil_moisture_2();
+    values[SensorHistory::CH_WATER] = sensors.get_water_volume().getRaw();
+    history.append(values);
+}
+
+void storageTask() {
+    EepromLog::Snapshot snapshot;
+    snapshot.time = sensors.get_time();
+    snapshot.temperature = sensors.get_air_temp();
+    snapshot.humidity = sensors.get_air_humidity();
+    snapshot.co2 = sensors.get_air_CO2();
+    snapshot.light = sensors.get_light_level();
+    snapshot.soil1 = sensors.get_soil_moisture_1();
+    snapshot.soil2 = sensors.get_soil_moisture_2();
+    snapshot.water = sensors.get_water_volume();
+    if (!eepromLog.logSnapshot(snapshot)) {
+        LOG_WARN(STORAGE, EV_EEPROM_LOG_DROP, "EEPROM log queue full", eepromLog.getDroppedRecords());
+    }
+}
+
+void onDeviceChange(DeviceManager::Device device, bool state) {
+    if (!eepromLog.logDevice(sensors.get_time(), device, state)) {
+        LOG_WARN(STORAGE, EV_EEPROM_LOG_DROP, "EEPROM log queue full", eepromLog.getDroppedRecords());
+    }
+}
+
+void telemetryTask() {
+    telemetry.pump();
+}
+
+void displayTask() {
+    display.update();
+}
+
+void autoModeTask() {
+    if (systemAutoMode) {
+        runAutoMode();
+    }
+}
+
+void fanTask() {
+    if (!systemAutoMode) return;
+    if (!sensors.is_air_temp_sensor_ok()) {
+        devices.setFanSpeed(rulesFanOn ? 255 : FAN_FAILSAFE_SPEED);
+        return;
+    }
+    // Устаревший замер CO2 без ENS160 не должен держать вентилятор
+    uint8_t speed = fanController.update(sensors.get_air_temp(), sensors.get_air_humidity(), sensors.get_air_CO2(),
+                                         sensors.is_air_qual_sensor_ok());
+    devices.setFanSpeed(rulesFanOn ? 255 : speed);
+}
+
+void irrigationTask() {
+    pumpCalibrator.update(sensors.get_water_volume(), sensors.is_water_sensor_ok());
+    if (!systemAutoMode) {
+        if (irrigation.isActive()) irrigation.abort();
+        return;
+    }
+
+    // Средняя влажность по исправным датчикам
+    Irrigation::Inputs inputs;
+    uint16_t soil = 0;
+    uint8_t probes = 0;
+    if (sensors.is_soil_sensor_1_ok()) { soil += sensors.get_soil_moisture_1(); probes++; }
+    if (sensors.is_soil_sensor_2_ok()) { soil += sensors.get_soil_moisture_2(); probes++; }
+    inputs.soil = probes > 0 ? soil / probes : 0;
+    inputs.soilValid = probes > 0;
+    inputs.water = sensors.get_water_volume();
+    inputs.waterValid = sensors.is_water_sensor_ok();
+    inputs.day = sensors.get_day();
+    inputs.time = sensors.is_rtc_ok() ? sensors.get_time() : 0;
+    irrigation.update(inputs);
+}
+
+// Команды из Serial: 't' - кольцо журнала, 'e' - журнал в EEPROM, 'l' - правила,
+// 'u' - загрузка таблицы правил, 'i' - шина I2C,
+// 'h' - исправность датчиков, 'm' - память, 'p'/'r' - профиль задач (при TASK_PROFILING)
+void consoleTask() {
+    if (rules.isReceiving()) {
+        rules.receive(Serial);
+        return;
+    }
+
+    while (Serial.available() > 0) {
+        int cmd = Serial.read();
+        if (cmd == 't') {
+            Log::dumpTrace(Serial);
+        } else if (cmd == 'e') {
+            eepromLog.dump(Serial);
+        } else if (cmd == 'l') {
+            rules.dump(Serial);
+        } else if (cmd == 'i') {
+            I2cBus::dump(Serial);
+        } else if (cmd == 'h') {
+            sensors.get_health().dump(Serial);
+        } else if (cmd == 'm') {
+            MemoryMonitor::dump(Serial);
+            MemoryMonitor::dumpObjects(Serial, RAM_OBJECTS, sizeof(RAM_OBJECTS) / sizeof(RAM_OBJECTS[0]));
+        } else if (cmd == RuleTable::UPLOAD_COMMAND) {
+            rules.startUpload();
+            rules.receive(Serial);
+            return;
+        }
+#ifdef TASK_PROFILING
+        else if (cmd == 'p') {
+            scheduler.dumpProfile(Serial);
+        } else if (cmd == 'r') {
+            scheduler.resetProfile();
+        }
+#endif
+    }
+}
+
+static_assert(TASK_COUNT <= TaskScheduler::MAX_TASKS, "scheduler table too small for setup() tasks");
+
+// Задача, не попавшая в таблицу, молча не работала бы
+static int8_t addTask(TaskScheduler::TaskCallback callback, uint32_t period, uint32_t phase = 0, uint32_t deadline = 0) {
+    int8_t id = scheduler.addTask(callback, period, phase, deadline);
+    if (id == TaskScheduler::INVALID_TASK) {
+        LOG_ERROR(MAIN, EV_TASK_REJECTED, "Task not added, tasks", scheduler.getTaskCount());
+    }
+    return id;
+}
 
 void setup() {
     Serial.begin(9600);
+    Log::begin(Serial);
     sensors.init();
     devices.init();
+    LOG_INFO(STORAGE, EV_EEPROM_LOG_OK, "EEPROM log records", eepromLog.begin());
+    devices.setStateListener(onDeviceChange);
+    pumpCalibrator.begin();
+    irrigation.begin(sensors.is_rtc_ok() ? sensors.get_time() : 0);
+    dailyLight.begin(sensors.get_time());
+    rules.begin(DEFAULT_RULES, sizeof(DEFAULT_RULES) / RuleTable::RULE_SIZE);
+    LOG_INFO(MAIN, EV_RULES_OK, "Rules", rules.getRuleCount());
     display.begin();
+
+    // Порядок регистрации = приоритет. Насос первым: от него зависит безопасность
+    int8_t id;
+    id = addTask(devicesTask, DEVICES_PERIOD_MS, 0, DEVICES_PERIOD_MS);
+    TASK_NAME(scheduler, id, "devices");
+    id = addTask(sensorsPollTask, SENSORS_POLL_PERIOD_MS, 1);
+    TASK_NAME(scheduler, id, "poll");
+    id = addTask(sensorsTask, SENSORS_PERIOD_MS, 0, SENSORS_PERIOD_MS / 2);
+    TASK_NAME(scheduler, id, "sensors");
+    id = addTask(displayTask, DISPLAY_PERIOD_MS, 5, DISPLAY_PERIOD_MS);
+    TASK_NAME(scheduler, id, "display");
+    id = addTask(autoModeTask, AUTO_MODE_PERIOD_MS, AUTO_MODE_PERIOD_MS, AUTO_MODE_PERIOD_MS / 2);
+    TASK_NAME(scheduler, id, "automode");
+    // Сразу после обновления датчиков
+    id = addTask(fanTask, FAN_CONTROL_PERIOD_MS, 10);
+    TASK_NAME(scheduler, id, "fan");
+    // После первого замера бака, иначе пустой бак на старте
+    id = addTask(irrigationTask, IRRIGATION_PERIOD_MS, SENSORS_PERIOD_MS * 2);
+    TASK_NAME(scheduler, id, "irrigation");
+    id = addTask(historyTask, SensorHistory::SAMPLE_PERIOD_MS, SENSORS_PERIOD_MS * 2);
+    TASK_NAME(scheduler, id, "history");
+    id = addTask(storageTask, STORAGE_PERIOD_MS, SENSORS_PERIOD_MS * 3);
+    TASK_NAME(scheduler, id, "storage");
+    id = addTask(telemetryTask, TELEMETRY_PERIOD_MS, 3);
+    TASK_NAME(scheduler, id, "telemetry");
+    id = addTask(consoleTask, CONSOLE_PERIOD_MS);
+    TASK_NAME(scheduler, id, "console");
+    id = addTask(MemoryMonitor::update, MEMORY_PERIOD_MS);
+    TASK_NAME(scheduler, id, "memory");
+
+    // Дальше строки журнала только при свободном месте в буфере UART
+    Log::setBlocking(false);
 }
 
 void loop() {
-    static uint32_t lastSensorUpdate = 0;
-    if (millis() - lastSensorUpdate > 1000) {
-        sensors.update_all();
-        updateDisplayWithSensorData();
-        lastSensorUpdate = millis();
-    }
-    // 3. Обновление UI
-    display.update();
-    //4. Обновление устройств (для насоса с автостопом)
-    devices.update();
+    scheduler.run();
+}
 
-    if (systemAutoMode) {
-        runAutoMode();
-    }
-    delay(50);
+// Входы правил - int16, большие значения (свет днем) упираются в предел
+// Единицы входов - RuleTable::Input; в int16 не влезает только eCO2 выше 32767 ppm
+static int16_t ruleInput(uint32_t value, uint8_t unit) {
+    value = (value + unit / 2) / unit;
+    return value > INT16_MAX ? INT16_MAX : static_cast<int16_t>(value);
 }
 
-// TODO: complete autologic with watering, complete error handler
+// Политика задана таблицей правил, здесь только входы и исполнение
 void runAutoMode() {
+    RuleEngine::Inputs inputs;
+    inputs.values[RuleTable::IN_ALWAYS] = 0;
+    inputs.values[RuleTable::IN_TEMPERATURE] = sensors.get_air_temp().getRaw();
+    inputs.values[RuleTable::IN_HUMIDITY] = sensors.get_air_humidity().getRaw();
+    inputs.values[RuleTable::IN_CO2] = ruleInput(sensors.get_air_CO2().getRaw(), 1);
+    inputs.values[RuleTable::IN_LIGHT] = ruleInput(sensors.get_light_level().getRaw(), RuleTable::LUX_PER_UNIT);
+    inputs.values[RuleTable::IN_SOIL_1] = sensors.get_soil_moisture_1();
+    inputs.values[RuleTable::IN_SOIL_2] = sensors.get_soil_moisture_2();
+    inputs.values[RuleTable::IN_WATER] = ruleInput(sensors.get_water_volume().getRaw(), RuleTable::ML_PER_UNIT);
+    inputs.hour = sensors.get_hour();
 
-    static uint32_t lastAutoAction = 0;
-    if (millis() - lastAutoAction > 10000) {  // Каждые 10 секунд
-        lastAutoAction = millis();
+    inputs.validMask = 1 << RuleTable::IN_ALWAYS;
+    if (sensors.is_air_temp_sensor_ok()) inputs.validMask |= (1 << RuleTable::IN_TEMPERATURE) | (1 << RuleTable::IN_HUMIDITY);
+    if (sensors.is_air_qual_sensor_ok()) inputs.validMask |= 1 << RuleTable::IN_CO2;
+    if (sensors.is_light_sensor_ok()) inputs.validMask |= 1 << RuleTable::IN_LIGHT;
+    if (sensors.is_soil_sensor_1_ok()) inputs.validMask |= 1 << RuleTable::IN_SOIL_1;
+    if (sensors.is_soil_sensor_2_ok()) inputs.validMask |= 1 << RuleTable::IN_SOIL_2;
+    if (sensors.is_water_sensor_ok()) inputs.validMask |= 1 << RuleTable::IN_WATER;
 
-        if ((sensors.get_light_level() < 50 || sensors.get_hour() > 20 || sensors.get_hour() < 8) &&
-            !devices.isLightOn()) {
-            devices.setLight(true);
-        } else if ((sensors.get_light_level() > 500 && sensors.get_hour() > 8) && devices.isLightOn()) {
-            devices.setLight(false);
-        }
+    RuleEngine::Outputs outputs;
+    rules.evaluate(inputs, outputs);
 
-        if (((sensors.get_air_temp() > 35) || (sensors.get_air_humidity() > 85) || (sensors.get_air_CO2() > 1200)) &&
-            !devices.isFanOn()) {
-            devices.setFan(true);
-        } else if ((sensors.get_air_temp() < 25 || (sensors.get_air_humidity() < 60) ||
-                    (sensors.get_air_CO2() < 50)) && devices.isFanOn()) {
-            devices.setFan(false);
-        }
+    rulesLightOn = outputs.light;
+    rulesFanOn = outputs.fan;
+    // Насос только через полив порциями: там проверки бака и лимитов
+    if (outputs.pumpMl > 0) {
+        irrigation.request(outputs.pumpMl);
+    }
+    if (outputs.alert < ALERT_COUNT) {
+        display.showMessage(reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&alertLines[outputs.alert][0])),
+                            reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&alertLines[outputs.alert][1])),
+                            ALERT_SHOW_MS, GreenhouseDisplay::PRIORITY_ALERT);
+    }
+}
 
-        //TODO:Fix magic number usage
-        if (((sensors.get_soil_moisture_1() < 20))) {
-            //devices.startPump(100);
-            display.backlightOn();
-            display.showMessage("WATER", "NOW", 50000);
-        }
+// Интеграл света считается и в ручном режиме, лампой управляет только автоматика.
+// Без датчика света досветка выключается: недобор не измерить
+void updateLighting() {
+    uint8_t duty = dailyLight.update(sensors.get_light_level(), sensors.is_light_sensor_ok(),
+                                     devices.getLightDuty(), sensors.get_time());
+    if (!sensors.is_light_sensor_ok()) duty = 0;
+    if (systemAutoMode) {
+        devices.setLightLevel(rulesLightOn ? 255 : duty);
+    }
+}
+
+// Направление изменения канала за последние window отсчетов истории
+int8_t historyTrend(SensorHistory::Channel channel, uint8_t window, int32_t threshold) {
+    SensorHistory::Stats stats;
+    if (!history.query(channel, window, stats) || stats.count < 2) {
+        return 0;
+    }
+    if (stats.slopePerHour >= threshold) return 1;
+    if (stats.slopePerHour <= -threshold) return -1;
+    return 0;
+}
+
+// Список отказавших датчиков на дисплее, пока хоть один не работает
+void updateSensorFaults() {
+    uint8_t faults = sensors.get_health().getFailedMask();
+    if (faults == shownSensorFaults) return;
+    shownSensorFaults = faults;
+    if (faults == 0) {
+        display.clearError();
+        return;
+    }
 
+    char message[GreenhouseDisplay::ERROR_MESSAGE_LENGTH + 1];
+    strcpy_P(message, PSTR("FAIL"));
+    for (uint8_t i = 0; i < SensorHealth::SENSOR_COUNT; i++) {
+        if (!(faults & (1 << i))) continue;
+        PGM_P name = reinterpret_cast<PGM_P>(SensorHealth::getName(static_cast<SensorHealth::Sensor>(i)));
+        size_t used = strlen(message);
+        if (used + 1 + strlen_P(name) > GreenhouseDisplay::ERROR_MESSAGE_LENGTH) break;
+        message[used] = ' ';
+        strcpy_P(message + used + 1, name);
     }
+    display.setError(message);
 }
 
 void updateDisplayWithSensorData() {
+    updateSensorFaults();
     // Передача всех данных сенсоров
     display.setTemperature(sensors.get_air_temp());
     display.setHumidity(sensors.get_air_humidity());
@@ -75,12 +372,56 @@ void updateDisplayWithSensorData() {
     display.setLightLevel(sensors.get_light_level());
     display.setWaterVolume(sensors.get_water_volume());
     display.setAirQuality(sensors.get_air_CO2());
+    display.setTemperatureTrend(historyTrend(SensorHistory::CH_TEMPERATURE, TEMP_TREND_WINDOW, TEMP_TREND_PER_HOUR));
+    display.setSoilTrend(historyTrend(SensorHistory::CH_SOIL_1, SOIL_TREND_WINDOW, SOIL_TREND_PER_HOUR));
     display.setTime(sensors.get_hour(),sensors.get_minute());
     // Передача состояния устройств
     display.setLightState(devices.isLightOn());
     display.setFanState(devices.isFanOn());
     display.setPumpState(devices.isPumpOn());
+    display.setFreeMemory(MemoryMonitor::getUnused());
     display.setDate(sensors.get_day(), sensors.get_month(), sensors.get_year());
     // Установка режима работы
     display.setAutoMode(systemAutoMode);
 }
+
+void sendTelemetry() {
+    // До первой синхронизации часы стоят на грубом времени из begin(), кадр с ним сбил бы отметки
+    if (!sensors.get_clock().isSettled()) return;
+
+    TelemetryRecord r;
+    r.timeMs = millis();
+    r.lightLux = sensors.get_light_level().getRaw();
+    r.airTempDeci = sensors.get_air_temp().getRaw();
+    r.airHumDeci = sensors.get_air_humidity().getRaw();
+    r.eco2Ppm = sensors.get_air_CO2().getRaw();
+    r.tvocPpb = sensors.get_air_TVOC();
+    r.aqi = sensors.get_air_AQI();
+    r.waterDistMm = sensors.get_water_distance().getRaw();
+    r.waterVolumeMl = sensors.get_water_volume().getRaw();
+    r.soil1 = sensors.get_soil_moisture_1();
+    r.soil2 = sensors.get_soil_moisture_2();
+    r.hour = sensors.get_hour();
+    r.minute = sensors.get_minute();
+    r.second = sensors.get_second();
+    r.day = sensors.get_day();
+    r.month = sensors.get_month();
+    r.year = sensors.get_year();
+
+    r.sensorFlags = 0;
+    if (sensors.is_light_sensor_ok()) r.sensorFlags |= TelemetryFrame::SENSOR_LIGHT_OK;
+    if (sensors.is_air_temp_sensor_ok()) r.sensorFlags |= TelemetryFrame::SENSOR_AIR_TEMP_OK;
+    if (sensors.is_air_qual_sensor_ok()) r.sensorFlags |= TelemetryFrame::SENSOR_AIR_QUAL_OK;
+    if (sensors.is_soil_sensor_1_ok()) r.sensorFlags |= TelemetryFrame::SENSOR_SOIL_1_OK;
+    if (sensors.is_soil_sensor_2_ok()) r.sensorFlags |= TelemetryFrame::SENSOR_SOIL_2_OK;
+    if (sensors.is_rtc_ok()) r.sensorFlags |= TelemetryFrame::SENSOR_RTC_OK;
+    if (sensors.is_water_sensor_ok()) r.sensorFlags |= TelemetryFrame::SENSOR_WATER_OK;
+
+    r.actuatorFlags = 0;
+    if (devices.isLightOn()) r.actuatorFlags |= TelemetryFrame::ACTUATOR_LIGHT;
+    if (devices.isFanOn()) r.actuatorFlags |= TelemetryFrame::ACTUATOR_FAN;
+    if (devices.isPumpOn()) r.actuatorFlags |= TelemetryFrame::ACTUATOR_PUMP;
+    if (systemAutoMode) r.actuatorFlags |= TelemetryFrame::ACTUATOR_AUTO_MODE;
+
+    telemetry.sendReadings(r);
+}
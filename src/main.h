@@ -5,10 +5,92 @@
 #include "SensorManager.h"
 #include "DeviceManager.h"
 #include "SimpleLCD.h"
+#include "TaskScheduler.h"
+#include "Telemetry.h"
+#include "Log.h"
+#include "SensorHistory.h"
+#include "EepromLog.h"
+#include "FanController.h"
+#include "RuleEngine.h"
+#include "Irrigation.h"
+#include "PumpCalibrator.h"
+#include "DailyLight.h"
+#include "I2cBus.h"
+#include "MemoryMonitor.h"
 
 const uint8_t LIGHT_PIN = 6;
 const uint8_t FAN_PIN = 5;
 const uint8_t PUMP_PIN = 7;
+// Периоды задач планировщика, мс
+const uint32_t DEVICES_PERIOD_MS = 10;
+const uint32_t SENSORS_POLL_PERIOD_MS = 20;
+const uint32_t SENSORS_PERIOD_MS = 1000;
+const uint32_t DISPLAY_PERIOD_MS = 100;
+const uint32_t AUTO_MODE_PERIOD_MS = 10000;
+const uint32_t FAN_CONTROL_PERIOD_MS = 1000;  // как обновление датчиков
+static_assert(FAN_CONTROL_PERIOD_MS * 2 <= FanController::MAX_DT_MS, "fan period must leave room for one late step");
+const uint32_t IRRIGATION_PERIOD_MS = 1000;
+const uint32_t TELEMETRY_PERIOD_MS = 20;  // 64 байта буфера UART на 9600 бод уходят за ~67 мс
+const uint32_t CONSOLE_PERIOD_MS = 200;
+const uint32_t MEMORY_PERIOD_MS = 5000;
+const uint8_t TASK_COUNT = 12;  // задач регистрирует setup()
+// Снимок в EEPROM раз в 30 минут: 48 слотов хватает примерно на сутки
+const uint32_t STORAGE_PERIOD_MS = 30UL * 60UL * 1000UL;
+// Тренды на дисплее: окно истории (отсчетов) и порог наклона в единицах канала за час.
+// Почва шумит на +-1 % и сохнет медленно, поэтому окно длиннее
+const uint8_t TEMP_TREND_WINDOW = 15;
+const int32_t TEMP_TREND_PER_HOUR = 10;  // 1 °C/ч
+const uint8_t SOIL_TREND_WINDOW = 60;
+const int32_t SOIL_TREND_PER_HOUR = 1;   // 1 %/ч
+// Вентиляция: уставки, полосы (ошибка в одну полосу = 100 %), веса каналов, коэффициенты ПИД
+const FanController::Config FAN_CONFIG = {
+    DeciCelsius::fromInt(28), DeciCelsius::fromInt(5),
+    DeciPercent::fromInt(75), DeciPercent::fromInt(10),
+    Ppm::fromInt(1000), Ppm::fromInt(400),
+    100, 80, 60,
+    16, 1, 0,
+    300, 50  // включение не раньше, чем понадобится минимальная скорость (30 %)
+};
+// Без датчика температуры и влажности вентилятор проветривает вполсилы
+const uint8_t FAN_FAILSAFE_SPEED = 128;
+// Полив: от 30 до 40 % порциями по 50 мл (30 с насоса) с паузой 10 минут,
+// не больше 1 л в сутки и не чаще раза в 2 часа, в баке остается 2 л
+const Irrigation::Config IRRIGATION_CONFIG = {
+    30, 40,
+    50, 10UL * 60UL * 1000UL, 6,
+    1000, 2UL * 60UL * 60UL * 1000UL,
+    2000
+};
+// Производительность насоса по паспорту, пока не измерена; одна оценка - по сумме
+// убыли за порции не меньше 5 л (дальномер различает ~0.8 л), рост больше 1 л - бак долили
+const PumpCalibrator::Config PUMP_CALIBRATION = {
+    100, SensorManager::get_tank_capacity().getRaw(),
+    5000, 1000
+};
+// Досветка: DLI 12 моль/м² за сутки с 4:00, лампа добирает недобор с 6 до 22 часов.
+// На полной мощности лампа прибавляет на датчике 8 клк (~150 мкмоль/м²/с)
+const DailyLight::Config DAILY_LIGHT_CONFIG = {
+    12000, 4,
+    6, 22,
+    54, 8000,
+    26  // 10 %
+};
+// Сообщения, которые правила показывают на дисплее (аргумент ACT_ALERT)
+enum Alert : uint8_t
+{
+    ALERT_WATER,
+    ALERT_REFILL,
+    ALERT_COUNT
+};
+const uint32_t ALERT_SHOW_MS = 50000;
+// Правила автоматики по умолчанию (формат - RuleTable.h), пока в EEPROM нет загруженных.
+// Досветкой управляет DailyLight, правило с ACT_LIGHT включит лампу на полную поверх него
+const uint8_t DEFAULT_RULES[] PROGMEM = {
+    // Почва пересохла, хотя полив автоматический, - предупреждение на дисплее
+    RULE_BYTES(RuleTable::IN_SOIL_1, RuleTable::OP_LESS, false, 20, 0, 0, 0, RuleTable::ACT_ALERT, ALERT_WATER),
+    // В баке только резерв, полив остановлен
+    RULE_BYTES(RuleTable::IN_WATER, RuleTable::OP_LESS, false, 25, 5, 0, 0, RuleTable::ACT_ALERT, ALERT_REFILL),
+};
 uint8_t last_time_vent = 23;
 uint8_t venting_time = 15;
 bool isVenting = false;
@@ -19,4 +101,5 @@ const uint8_t ENC_DT = 3;
 const uint8_t ENC_SW = 4;
 */
 void updateDisplayWithSensorData();
+int8_t historyTrend(SensorHistory::Channel channel, uint8_t window, int32_t threshold);
 #endif
\ No newline at end of file
@@ -0,0 +1,355 @@
+// Компилятор правил автоматики теплицы в упакованную таблицу (Linux).
+//
+// Сборка:  g++ -std=c++11 -O2 -I../src rule_compile.cpp -o rule_compile
+// Запуск:  ./rule_compile rules.txt > rules.bin           таблица целиком
+//          ./rule_compile -c rules.txt                    строки RULE_BYTES для DEFAULT_RULES
+//          ./rule_compile -u /dev/ttyACM0 rules.txt [baud] загрузка в контроллер
+//
+// Одна строка - одно правило, условия через '&' проверяются вместе:
+//   lux < 50 hyst 450 -> light
+//   always at 21-8 -> light
+//   temp > 30.5 at 10-18 & co2 > 1500 -> fan
+//   soil1 < 20 hyst 5 -> pump 150
+//   soil1 < 20 -> alert 0
+// Входы: always temp hum co2 lux soil1 soil2 water (temp и hum - с десятыми, lux в лк,
+// water в мл; в таблицу lux идет в 10 лк, water - в 100 мл, с округлением).
+// Действия: light, fan, pump <мл>, alert <номер>. '#' - комментарий.
+// Пустой файл - таблица без правил: контроллер вернется к правилам по умолчанию.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "RuleTable.h"
+
+static const char* const inputNames[RuleTable::INPUT_COUNT] = {"always", "temp", "hum", "co2",
+                                                               "lux",    "soil1", "soil2", "water"};
+static const char* const actionNames[RuleTable::ACTION_COUNT] = {"&", "light", "fan", "pump", "alert"};
+
+static int findName(const char* const* names, int count, const char* name)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// Значение в единицах входа таблицы: у temp и hum - десятые доли, lux и water укрупнены
+static bool parseValue(RuleTable::Input input, const char* text, long& result)
+{
+    char* end = nullptr;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0')
+        return false;
+    if (input == RuleTable::IN_TEMPERATURE || input == RuleTable::IN_HUMIDITY)
+        value *= 10.0;
+    else if (input == RuleTable::IN_LIGHT)
+        value /= RuleTable::LUX_PER_UNIT;
+    else if (input == RuleTable::IN_WATER)
+        value /= RuleTable::ML_PER_UNIT;
+    result = lround(value);
+    return true;
+}
+
+static bool parseWindow(const char* text, RuleTable::Rule& rule)
+{
+    int from, to;
+    char tail;
+    if (sscanf(text, "%d-%d%c", &from, &to, &tail) != 2 || from < 0 || from > 23 || to < 0 || to > 23)
+        return false;
+    rule.fromHour = static_cast<uint8_t>(from);
+    rule.toHour = static_cast<uint8_t>(to);
+    return true;
+}
+
+struct Compiler
+{
+    RuleTable::Rule rules[RuleTable::MAX_RULES];
+    int count;
+    const char* path;
+    int line;
+
+    bool error(const char* message, const char* token)
+    {
+        fprintf(stderr, "%s:%d: %s%s%s\n", path, line, message, token ? ": " : "", token ? token : "");
+        return false;
+    }
+
+    bool compileLine(char* text)
+    {
+        char* tokens[32];
+        int n = 0;
+        for (char* t = strtok(text, " \t\r\n"); t != nullptr && n < 32; t = strtok(nullptr, " \t\r\n"))
+        {
+            tokens[n++] = t;
+        }
+        if (n == 0)
+            return true;
+
+        int i = 0;
+        for (;;)
+        {
+            if (count >= RuleTable::MAX_RULES)
+                return error("too many rules", nullptr);
+
+            RuleTable::Rule& rule = rules[count++];
+            memset(&rule, 0, sizeof(rule));
+
+            if (i >= n)
+                return error("condition expected", nullptr);
+            int input = findName(inputNames, RuleTable::INPUT_COUNT, tokens[i]);
+            if (input < 0)
+                return error("unknown input", tokens[i]);
+            rule.input = static_cast<RuleTable::Input>(input);
+            i++;
+
+            if (rule.input != RuleTable::IN_ALWAYS)
+            {
+                if (i + 1 >= n)
+                    return error("comparison expected", nullptr);
+                if (strcmp(tokens[i], "<") == 0)
+                    rule.op = RuleTable::OP_LESS;
+                else if (strcmp(tokens[i], ">") == 0)
+                    rule.op = RuleTable::OP_GREATER;
+                else
+                    return error("'<' or '>' expected", tokens[i]);
+
+                long threshold;
+                if (!parseValue(rule.input, tokens[i + 1], threshold) || threshold < INT16_MIN || threshold > INT16_MAX)
+                    return error("bad threshold", tokens[i + 1]);
+                rule.threshold = static_cast<int16_t>(threshold);
+                i += 2;
+            }
+
+            while (i < n && (strcmp(tokens[i], "hyst") == 0 || strcmp(tokens[i], "at") == 0))
+            {
+                if (i + 1 >= n)
+                    return error("value expected after", tokens[i]);
+                if (strcmp(tokens[i], "at") == 0)
+                {
+                    if (!parseWindow(tokens[i + 1], rule))
+                        return error("bad hour window (expected H-H)", tokens[i + 1]);
+                }
+                else
+                {
+                    long hysteresis;
+                    if (!parseValue(rule.input, tokens[i + 1], hysteresis) || hysteresis < 0 || hysteresis > UINT16_MAX)
+                        return error("bad hysteresis", tokens[i + 1]);
+                    rule.hysteresis = static_cast<uint16_t>(hysteresis);
+                }
+                i += 2;
+            }
+
+            if (i >= n)
+                return error("'&' or '->' expected", nullptr);
+            if (strcmp(tokens[i], "&") == 0)
+            {
+                rule.andNext = true;
+                i++;
+                continue;
+            }
+            if (strcmp(tokens[i], "->") != 0)
+                return error("'&' or '->' expected", tokens[i]);
+            i++;
+
+            if (i >= n)
+                return error("action expected", nullptr);
+            int action = findName(actionNames, RuleTable::ACTION_COUNT, tokens[i]);
+            if (action <= RuleTable::ACT_NONE)
+                return error("unknown action", tokens[i]);
+            rule.action = static_cast<RuleTable::Action>(action);
+            i++;
+
+            if (rule.action == RuleTable::ACT_PUMP || rule.action == RuleTable::ACT_ALERT)
+            {
+                if (i >= n)
+                    return error("argument expected", nullptr);
+                long arg = strtol(tokens[i], nullptr, 10);
+                if (rule.action == RuleTable::ACT_PUMP)
+                {
+                    if (arg < 10 || arg > 2550 || arg % 10 != 0)
+                        return error("pump volume must be 10..2550 ml in steps of 10", tokens[i]);
+                    arg /= 10;
+                }
+                else if (arg < 0 || arg > 254)
+                {
+                    return error("bad alert number", tokens[i]);
+                }
+                rule.arg = static_cast<uint8_t>(arg);
+                i++;
+            }
+
+            if (i < n)
+                return error("unexpected", tokens[i]);
+            return true;
+        }
+    }
+
+    bool compile(FILE* in)
+    {
+        char text[256];
+        while (fgets(text, sizeof(text), in) != nullptr)
+        {
+            line++;
+            char* hash = strchr(text, '#');
+            if (hash != nullptr)
+                *hash = '\0';
+            if (!compileLine(text))
+                return false;
+        }
+        return true;
+    }
+
+    size_t encode(uint8_t* out) const
+    {
+        uint8_t crc = 0xFF;
+        uint8_t* p = out + RuleTable::HEADER_SIZE;
+        for (int i = 0; i < count; i++)
+        {
+            RuleTable::encode(rules[i], p);
+            for (uint8_t k = 0; k < RuleTable::RULE_SIZE; k++)
+            {
+                crc = RuleTable::crc8Update(crc, p[k]);
+            }
+            p += RuleTable::RULE_SIZE;
+        }
+        out[0] = RuleTable::MAGIC;
+        out[1] = RuleTable::VERSION;
+        out[2] = static_cast<uint8_t>(count);
+        out[3] = crc;
+        return static_cast<size_t>(p - out);
+    }
+
+    void printInitializer() const
+    {
+        static const char* const inputConst[RuleTable::INPUT_COUNT] = {
+            "IN_ALWAYS", "IN_TEMPERATURE", "IN_HUMIDITY", "IN_CO2", "IN_LIGHT", "IN_SOIL_1", "IN_SOIL_2", "IN_WATER"};
+        static const char* const actionConst[RuleTable::ACTION_COUNT] = {"ACT_NONE", "ACT_LIGHT", "ACT_FAN",
+                                                                         "ACT_PUMP", "ACT_ALERT"};
+        for (int i = 0; i < count; i++)
+        {
+            const RuleTable::Rule& r = rules[i];
+            printf("    RULE_BYTES(RuleTable::%s, RuleTable::%s, %s, %d, %u, %u, %u, RuleTable::%s, %u),\n",
+                   inputConst[r.input], r.op == RuleTable::OP_LESS ? "OP_LESS" : "OP_GREATER",
+                   r.andNext ? "true" : "false", r.threshold, r.hysteresis, r.fromHour, r.toHour,
+                   actionConst[r.action], r.arg);
+        }
+    }
+};
+
+static speed_t baudConstant(long baud)
+{
+    switch (baud)
+    {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    default: return 0;
+    }
+}
+
+static bool upload(const char* device, long baud, const uint8_t* table, size_t size)
+{
+    int fd = open(device, O_WRONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        perror(device);
+        return false;
+    }
+    if (isatty(fd))
+    {
+        struct termios tio;
+        speed_t speed = baudConstant(baud);
+        if (speed == 0 || tcgetattr(fd, &tio) != 0)
+        {
+            fprintf(stderr, "cannot configure %s at %ld baud\n", device, baud);
+            close(fd);
+            return false;
+        }
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    // Контроллер пишет EEPROM в фоне и забирает байты по одному: шлем с паузами
+    uint8_t command = RuleTable::UPLOAD_COMMAND;
+    bool ok = write(fd, &command, 1) == 1;
+    for (size_t i = 0; ok && i < size; i++)
+    {
+        usleep(RuleTable::UPLOAD_BYTE_GAP_MS * 1000);
+        ok = write(fd, table + i, 1) == 1;
+    }
+    if (!ok)
+        perror("write");
+    close(fd);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    bool initializer = false;
+    const char* device = nullptr;
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-c") == 0)
+    {
+        initializer = true;
+        arg++;
+    }
+    else if (arg + 1 < argc && strcmp(argv[arg], "-u") == 0)
+    {
+        device = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg >= argc)
+    {
+        fprintf(stderr, "usage: %s [-c | -u <device>] <rules|-> [baud]\n", argv[0]);
+        return 2;
+    }
+
+    Compiler compiler;
+    compiler.count = 0;
+    compiler.path = argv[arg];
+    compiler.line = 0;
+
+    FILE* in = strcmp(argv[arg], "-") == 0 ? stdin : fopen(argv[arg], "r");
+    if (in == nullptr)
+    {
+        perror(argv[arg]);
+        return 1;
+    }
+    bool ok = compiler.compile(in);
+    if (in != stdin)
+        fclose(in);
+    if (!ok)
+        return 1;
+
+    uint8_t table[RuleTable::HEADER_SIZE + RuleTable::MAX_RULES * RuleTable::RULE_SIZE];
+    size_t size = compiler.encode(table);
+
+    if (initializer)
+    {
+        compiler.printInitializer();
+    }
+    else if (device != nullptr)
+    {
+        if (!upload(device, arg + 1 < argc ? atol(argv[arg + 1]) : 9600, table, size))
+            return 1;
+        fprintf(stderr, "%d rules, %zu bytes sent\n", compiler.count, size);
+    }
+    else
+    {
+        fwrite(table, 1, size, stdout);
+        fprintf(stderr, "%d rules, %zu bytes\n", compiler.count, size);
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+// Декодер двоичной телеметрии теплицы в CSV (Linux).
+//
+// Сборка:  g++ -std=c++11 -O2 -I../src telemetry_decode.cpp -o telemetry_decode
+// Запуск:  ./telemetry_decode /dev/ttyACM0 [baud] > log.csv
+//          ./telemetry_decode - < capture.bin > log.csv
+//
+// Текст в потоке (сообщения при старте, отчет профилировщика) пропускается:
+// кадр принимается только при совпадении синхробайтов и CRC.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "TelemetryFrame.h"
+
+static speed_t baudConstant(long baud)
+{
+    switch (baud)
+    {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    default: return 0;
+    }
+}
+
+static bool configurePort(int fd, long baud)
+{
+    speed_t speed = baudConstant(baud);
+    if (speed == 0)
+    {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return false;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        perror("tcgetattr");
+        return false;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        perror("tcsetattr");
+        return false;
+    }
+    return true;
+}
+
+static void printHeader()
+{
+    printf("seq,time_ms,date,time,light_lux,air_temp_c,air_hum_pct,eco2_ppm,tvoc_ppb,aqi,"
+           "water_dist_mm,water_volume_ml,soil1_pct,soil2_pct,sensor_flags,light,fan,pump,auto\n");
+}
+
+static void printDeci(long value)
+{
+    if (value < 0)
+    {
+        putchar('-');
+        value = -value;
+    }
+    printf("%ld.%ld", value / 10, value % 10);
+}
+
+static void printRecord(uint8_t seq, const TelemetryRecord& r)
+{
+    printf("%u,%lu,%04u-%02u-%02u,%02u:%02u:%02u,%lu,", seq, static_cast<unsigned long>(r.timeMs), r.year, r.month,
+           r.day, r.hour, r.minute, r.second, static_cast<unsigned long>(r.lightLux));
+    printDeci(r.airTempDeci);
+    putchar(',');
+    printDeci(r.airHumDeci);
+    printf(",%u,%u,%u,%u,%lu,%u,%u,0x%02X,%d,%d,%d,%d\n", r.eco2Ppm, r.tvocPpb, r.aqi, r.waterDistMm,
+           static_cast<unsigned long>(r.waterVolumeMl), r.soil1, r.soil2, r.sensorFlags,
+           (r.actuatorFlags & TelemetryFrame::ACTUATOR_LIGHT) != 0, (r.actuatorFlags & TelemetryFrame::ACTUATOR_FAN) != 0,
+           (r.actuatorFlags & TelemetryFrame::ACTUATOR_PUMP) != 0,
+           (r.actuatorFlags & TelemetryFrame::ACTUATOR_AUTO_MODE) != 0);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <device|file|-> [baud]\n", argv[0]);
+        return 2;
+    }
+
+    int fd = STDIN_FILENO;
+    if (strcmp(argv[1], "-") != 0)
+    {
+        fd = open(argv[1], O_RDONLY | O_NOCTTY);
+        if (fd < 0)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+        if (isatty(fd) && !configurePort(fd, argc > 2 ? atol(argv[2]) : 9600))
+        {
+            return 1;
+        }
+    }
+
+    printHeader();
+
+    // Автомат разбора: ищем синхробайты, затем набираем кадр целиком
+    uint8_t frame[TelemetryFrame::HEADER_SIZE + TelemetryFrame::MAX_PAYLOAD + TelemetryFrame::CRC_SIZE];
+    size_t have = 0;
+    size_t need = TelemetryFrame::HEADER_SIZE;
+
+    unsigned long frames = 0;
+    unsigned long crcErrors = 0;
+    unsigned long lost = 0;
+    unsigned long skipped = 0;
+    int lastSeq = -1;
+
+    uint8_t chunk[256];
+    for (;;)
+    {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+
+        for (ssize_t i = 0; i < n; i++)
+        {
+            uint8_t b = chunk[i];
+
+            if (have == 0 && b != TelemetryFrame::SYNC_1)
+            {
+                skipped++;
+                continue;
+            }
+            if (have == 1 && b != TelemetryFrame::SYNC_2)
+            {
+                skipped++;
+                have = (b == TelemetryFrame::SYNC_1) ? 1 : 0;
+                continue;
+            }
+
+            frame[have++] = b;
+
+            if (have == TelemetryFrame::HEADER_SIZE)
+            {
+                uint8_t len = frame[2];
+                if (len > TelemetryFrame::MAX_PAYLOAD)
+                {
+                    skipped += have;
+                    have = 0;
+                    continue;
+                }
+                need = TelemetryFrame::HEADER_SIZE + len + TelemetryFrame::CRC_SIZE;
+            }
+
+            if (have < TelemetryFrame::HEADER_SIZE || have < need)
+                continue;
+
+            uint8_t len = frame[2];
+            uint16_t crc = 0xFFFF;
+            for (size_t k = 2; k < static_cast<size_t>(TelemetryFrame::HEADER_SIZE + len); k++)
+            {
+                crc = TelemetryFrame::crc16Update(crc, frame[k]);
+            }
+            uint16_t received = static_cast<uint16_t>(frame[need - 2] | (frame[need - 1] << 8));
+
+            have = 0;
+            need = TelemetryFrame::HEADER_SIZE;
+
+            if (crc != received)
+            {
+                // Мог быть ложный синхрослово внутри текста: просто ищем дальше
+                crcErrors++;
+                continue;
+            }
+
+            uint8_t type = frame[3];
+            uint8_t seq = frame[4];
+            if (lastSeq >= 0)
+            {
+                lost += static_cast<uint8_t>(seq - lastSeq - 1);
+            }
+            lastSeq = seq;
+            frames++;
+
+            if (type == TelemetryFrame::TYPE_READINGS && len == TelemetryFrame::READINGS_SIZE)
+            {
+                TelemetryRecord r;
+                TelemetryFrame::decodeReadings(frame + TelemetryFrame::HEADER_SIZE, r);
+                printRecord(seq, r);
+                fflush(stdout);
+            }
+        }
+    }
+
+    fprintf(stderr, "frames %lu, crc errors %lu, lost %lu, skipped bytes %lu\n", frames, crcErrors, lost, skipped);
+    return 0;
+}